@@ -0,0 +1,119 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace gba::bench {
+
+// Minimal self-contained microbenchmark harness for gba_bench.
+//
+// A benchmark body is called with an iteration count and returns how many
+// operations it performed (instructions, accesses, pixels...). The harness
+// calibrates the count so one repetition takes about min_time_ms, runs warmup
+// repetitions, then records ns/op for every measured repetition.
+
+struct Case {
+    std::string name;
+    std::string unit;                                   // what one "op" is
+    std::function<uint64_t(uint64_t iters)> body;
+};
+
+struct Config {
+    int warmup = 3;
+    int reps = 25;
+    double min_time_ms = 20.0;
+    std::string filter;                                 // substring match on name
+};
+
+struct Result {
+    std::string name;
+    std::string unit;
+    uint64_t iters{0};
+    uint64_t ops_per_rep{0};
+    double median_ns{0}, p99_ns{0}, min_ns{0}, mean_ns{0}; // per op
+};
+
+// Defeats dead-code elimination of benchmark results
+inline volatile uint64_t sink;
+inline void keep(uint64_t v) { sink = sink + v; }
+
+inline double run_once(const Case& c, uint64_t iters, uint64_t& ops) {
+    auto t0 = std::chrono::steady_clock::now();
+    ops = c.body(iters);
+    auto t1 = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(t1 - t0).count();
+}
+
+inline Result run_case(const Case& c, const Config& cfg) {
+    // Calibrate: grow iterations until a repetition is long enough to time
+    uint64_t iters = 1, ops = 0;
+    const double target_ns = cfg.min_time_ms * 1e6;
+    for (;;) {
+        double ns = run_once(c, iters, ops);
+        if (ns >= target_ns || iters >= (1ull << 40)) break;
+        double scale = ns > 0 ? target_ns / ns : 100.0;
+        scale = std::clamp(scale * 1.2, 1.5, 100.0);
+        iters = static_cast<uint64_t>(static_cast<double>(iters) * scale) + 1;
+    }
+
+    for (int i = 0; i < cfg.warmup; ++i) run_once(c, iters, ops);
+
+    std::vector<double> per_op;
+    per_op.reserve(static_cast<size_t>(cfg.reps));
+    for (int i = 0; i < cfg.reps; ++i) {
+        double ns = run_once(c, iters, ops);
+        per_op.push_back(ops ? ns / static_cast<double>(ops) : ns);
+    }
+    std::sort(per_op.begin(), per_op.end());
+
+    Result r;
+    r.name = c.name;
+    r.unit = c.unit;
+    r.iters = iters;
+    r.ops_per_rep = ops;
+    size_t n = per_op.size();
+    r.median_ns = (n % 2) ? per_op[n / 2] : 0.5 * (per_op[n / 2 - 1] + per_op[n / 2]);
+    // Nearest-rank percentile; with few reps this is the slowest rep
+    size_t rank = static_cast<size_t>(0.99 * static_cast<double>(n) + 0.999999);
+    r.p99_ns = per_op[std::min(n, std::max<size_t>(rank, 1)) - 1];
+    r.min_ns = per_op.front();
+    double sum = 0;
+    for (double v : per_op) sum += v;
+    r.mean_ns = sum / static_cast<double>(n);
+    return r;
+}
+
+inline void print_table(const std::vector<Result>& results) {
+    std::printf("%-40s %12s %12s %12s  %s\n", "benchmark", "median ns", "p99 ns", "min ns", "per");
+    for (const auto& r : results) {
+        std::printf("%-40s %12.3f %12.3f %12.3f  %s\n",
+            r.name.c_str(), r.median_ns, r.p99_ns, r.min_ns, r.unit.c_str());
+    }
+}
+
+inline bool write_json(const std::string& path, const Config& cfg, const std::vector<Result>& results) {
+    std::FILE* f = std::fopen(path.c_str(), "w");
+    if (!f) return false;
+    std::fprintf(f, "{\n  \"config\": {\"warmup\": %d, \"reps\": %d, \"min_time_ms\": %.3f},\n",
+        cfg.warmup, cfg.reps, cfg.min_time_ms);
+    std::fprintf(f, "  \"benchmarks\": [\n");
+    for (size_t i = 0; i < results.size(); ++i) {
+        const auto& r = results[i];
+        std::fprintf(f,
+            "    {\"name\": \"%s\", \"unit\": \"%s\", \"iters\": %llu, \"ops_per_rep\": %llu, "
+            "\"median_ns\": %.4f, \"p99_ns\": %.4f, \"min_ns\": %.4f, \"mean_ns\": %.4f}%s\n",
+            r.name.c_str(), r.unit.c_str(),
+            static_cast<unsigned long long>(r.iters), static_cast<unsigned long long>(r.ops_per_rep),
+            r.median_ns, r.p99_ns, r.min_ns, r.mean_ns,
+            (i + 1 < results.size()) ? "," : "");
+    }
+    std::fprintf(f, "  ]\n}\n");
+    std::fclose(f);
+    return true;
+}
+
+}
@@ -0,0 +1,231 @@
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+#include "bench.hpp"
+#include "../gba.hpp"
+#include "../tools/thumb_asm.hpp"
+#include "../tools/workloads.hpp"
+#include "../util/parse.hpp"
+
+// gba_bench: microbenchmarks for the CPU, Bus and PPU hot paths.
+//   gba_bench [--filter S] [--reps N] [--warmup N] [--min-time-ms X] [--json PATH] [--list]
+
+using gba::bench::Case;
+using gba::bench::keep;
+
+namespace {
+
+// Prologue (r1 = region base, r0 = 0 so Z is set), then BLOCK copies of `op`
+// and a branch back to the first copy.
+constexpr size_t BLOCK = 1024;
+
+std::vector<uint8_t> repeat_rom(uint16_t op, uint32_t base_hi_byte) {
+    gba::ThumbAsm a;
+    a.mov(1, base_hi_byte);
+    a.lsl(1, 1, 24);
+    a.mov(2, 3);
+    a.mov(0, 0);
+    gba::ThumbAsm::Label start = a.here();
+    for (size_t i = 0; i < BLOCK; ++i) a.emit(op);
+    a.b(start);
+    std::vector<uint8_t> rom;
+    a.assemble(rom);
+    return rom;
+}
+
+std::unique_ptr<gba::GBA> make_system(const std::vector<uint8_t>& rom) {
+    auto system = std::make_unique<gba::GBA>();
+    system->reset();
+    system->load(rom);
+    system->open_anonymous_save(gba::SaveMemory::detect(system->cart.rom));
+    return system;
+}
+
+// --- CPU: per-opcode-class dispatch ----------------------------------------
+
+struct OpClass { const char* name; uint16_t op; uint32_t base; };
+
+const OpClass OP_CLASSES[] = {
+    {"shift_imm_lsl",     0x0040,            0x02},
+    {"imm_mov",           0x2001,            0x02},
+    {"imm_cmp",           0x2801,            0x02},
+    {"imm_add",           0x3001,            0x02},
+    {"alu_and",           0x4008,            0x02},
+    {"alu_lsl_reg",       0x4088,            0x02},
+    {"alu_adc",           0x4148,            0x02},
+    {"alu_mul",           0x4348,            0x02},
+    {"ldr_literal",       0x4800,            0x02},
+    {"str_word_wram",     0x6008,            0x02},
+    {"ldr_word_wram",     0x6808,            0x02},
+    {"strb_wram",         0x7008,            0x02},
+    {"ldrb_wram",         0x7808,            0x02},
+    {"strh_wram",         0x8008,            0x02},
+    {"ldrh_wram",         0x8808,            0x02},
+    {"strh_vram",         0x8008,            0x06},
+    {"ldrh_vram",         0x8808,            0x06},
+    {"add_pc",            0xA000,            0x02},
+    {"bcond_taken",       0xD000,            0x02}, // BEQ +0 with Z set
+    {"bcond_not_taken",   0xD100,            0x02}, // BNE +0 with Z set
+    {"b_uncond",          0xE000,            0x02}, // B +0
+    {"unhandled",         0xB500,            0x02}, // PUSH: falls through every decoder check
+};
+
+void add_cpu_cases(std::vector<Case>& cases) {
+    for (const auto& oc : OP_CLASSES) {
+        auto system = std::shared_ptr<gba::GBA>(make_system(repeat_rom(oc.op, oc.base)));
+        cases.push_back({std::string("cpu/") + oc.name, "instr", [system](uint64_t iters) {
+            for (uint64_t i = 0; i < iters; ++i) system->cpu.step();
+            keep(system->cpu.r[0]);
+            return iters;
+        }});
+    }
+}
+
+// --- Bus: access cost per region and width ---------------------------------
+
+struct Region { const char* name; uint32_t base; uint32_t size; };
+
+const Region REGIONS[] = {
+    {"wram",     gba::Bus::WRAM_BASE, gba::Bus::WRAM_SIZE},
+    {"vram",     gba::Bus::VRAM_BASE, gba::Bus::VRAM_SIZE},
+    {"rom",      gba::Bus::ROM_BASE,  64 * 1024},
+    {"sram",     gba::Bus::SAVE_BASE, gba::Bus::SAVE_SIZE},
+    {"unmapped", 0x04000000,          64 * 1024},
+};
+
+// Walk the region with a cache-friendly stride; `width` keeps accesses aligned
+template <typename Fn>
+uint64_t walk(uint64_t iters, const Region& rg, uint32_t width, Fn&& fn) {
+    uint32_t mask = 0xFFFF & ~(width - 1);
+    if (rg.size < 0x10000) mask = (rg.size - 1) & ~(width - 1);
+    uint32_t off = 0;
+    for (uint64_t i = 0; i < iters; ++i) {
+        fn(rg.base + (off & mask));
+        off += 4 * width + width;
+    }
+    return iters;
+}
+
+void add_bus_cases(std::vector<Case>& cases) {
+    auto system = std::shared_ptr<gba::GBA>(make_system(std::vector<uint8_t>(64 * 1024, 0x5A)));
+    system->open_anonymous_save(gba::SaveType::Sram);
+    for (const auto& rg : REGIONS) {
+        std::string prefix = std::string("bus/") + rg.name + "/";
+        cases.push_back({prefix + "read8", "access", [system, rg](uint64_t n) {
+            uint64_t acc = 0;
+            walk(n, rg, 1, [&](uint32_t a) { acc += system->bus.read8(a); });
+            keep(acc); return n;
+        }});
+        cases.push_back({prefix + "read16", "access", [system, rg](uint64_t n) {
+            uint64_t acc = 0;
+            walk(n, rg, 2, [&](uint32_t a) { acc += system->bus.read16(a); });
+            keep(acc); return n;
+        }});
+        cases.push_back({prefix + "read32", "access", [system, rg](uint64_t n) {
+            uint64_t acc = 0;
+            walk(n, rg, 4, [&](uint32_t a) { acc += system->bus.read32(a); });
+            keep(acc); return n;
+        }});
+        cases.push_back({prefix + "write8", "access", [system, rg](uint64_t n) {
+            walk(n, rg, 1, [&](uint32_t a) { system->bus.write8(a, static_cast<uint8_t>(a)); });
+            return n;
+        }});
+        cases.push_back({prefix + "write16", "access", [system, rg](uint64_t n) {
+            walk(n, rg, 2, [&](uint32_t a) { system->bus.write16(a, static_cast<uint16_t>(a)); });
+            return n;
+        }});
+        cases.push_back({prefix + "write32", "access", [system, rg](uint64_t n) {
+            walk(n, rg, 4, [&](uint32_t a) { system->bus.write32(a, a); });
+            return n;
+        }});
+    }
+}
+
+// --- PPU: full-frame BGR555 -> ARGB8888 conversion --------------------------
+
+void add_ppu_cases(std::vector<Case>& cases) {
+    auto system = std::shared_ptr<gba::GBA>(make_system(std::vector<uint8_t>(2, 0)));
+    for (size_t i = 0; i < system->ppu.vram.size(); ++i) {
+        system->ppu.vram[i] = static_cast<uint16_t>((i * 2654435761u) >> 17);
+    }
+    auto argb = std::make_shared<std::vector<uint32_t>>();
+    cases.push_back({"ppu/render_mode3_to_argb", "frame", [system, argb](uint64_t n) {
+        for (uint64_t i = 0; i < n; ++i) system->render_mode3_to_argb(*argb);
+        keep((*argb)[n % argb->size()]);
+        return n;
+    }});
+}
+
+// --- End to end: frames/sec on generated workloads --------------------------
+
+void add_e2e_cases(std::vector<Case>& cases) {
+    for (const auto& w : gba::workloads()) {
+        gba::WorkloadParams params;
+        params.iterations = 0; // run forever so every frame does the same work
+        std::vector<uint8_t> rom;
+        if (!gba::build_workload(w.name, params, rom)) continue;
+        auto system = std::shared_ptr<gba::GBA>(make_system(rom));
+        auto argb = std::make_shared<std::vector<uint32_t>>();
+        cases.push_back({std::string("e2e/") + w.name, "frame", [system, argb](uint64_t n) {
+            for (uint64_t f = 0; f < n; ++f) {
+                for (int i = 0; i < gba::GBA::STEPS_PER_FRAME; ++i) system->cpu.step();
+                system->render_mode3_to_argb(*argb);
+            }
+            keep((*argb)[0]);
+            return n;
+        }});
+    }
+}
+
+void usage() {
+    std::fprintf(stderr,
+        "Usage: gba_bench [--filter S] [--reps N] [--warmup N] [--min-time-ms X] [--json PATH] [--list]\n");
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    gba::bench::Config cfg;
+    std::string jsonPath;
+    bool listOnly = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        bool ok = true;
+        if (arg == "--filter" && hasValue) cfg.filter = argv[++i];
+        else if (arg == "--reps" && hasValue) ok = gba::parse_uint(argv[++i], cfg.reps);
+        else if (arg == "--warmup" && hasValue) ok = gba::parse_uint(argv[++i], cfg.warmup);
+        else if (arg == "--min-time-ms" && hasValue) ok = gba::parse_double(argv[++i], cfg.min_time_ms) && cfg.min_time_ms >= 0;
+        else if (arg == "--json" && hasValue) jsonPath = argv[++i];
+        else if (arg == "--list") listOnly = true;
+        else ok = false;
+        if (!ok) { usage(); return 2; }
+    }
+    cfg.reps = std::max(1, cfg.reps);
+
+    std::vector<Case> cases;
+    add_cpu_cases(cases);
+    add_bus_cases(cases);
+    add_ppu_cases(cases);
+    add_e2e_cases(cases);
+
+    std::vector<gba::bench::Result> results;
+    for (const auto& c : cases) {
+        if (!cfg.filter.empty() && c.name.find(cfg.filter) == std::string::npos) continue;
+        if (listOnly) { std::printf("%s\n", c.name.c_str()); continue; }
+        results.push_back(gba::bench::run_case(c, cfg));
+        const auto& r = results.back();
+        std::fprintf(stderr, "%-40s %10.3f ns/%s\n", r.name.c_str(), r.median_ns, r.unit.c_str());
+    }
+    if (listOnly) return 0;
+
+    gba::bench::print_table(results);
+    if (!jsonPath.empty() && !gba::bench::write_json(jsonPath, cfg, results)) {
+        std::fprintf(stderr, "Failed to write %s\n", jsonPath.c_str());
+        return 1;
+    }
+    return 0;
+}
@@ -1,17 +1,24 @@
 #include "bus.hpp"
 #include "../ppu/ppu.hpp"
 #include "../cart/rom.hpp"
+#include "../debug/profiler.hpp"
 #include <cstring>
 #include <algorithm>
 
 namespace gba {
 
-void Bus::connect(PPU* ppu_, Cartridge* cart_) {
+void Bus::connect(PPU* ppu_, Cartridge* cart_, std::span<uint8_t> wram_) {
     ppu = ppu_;
     cart = cart_;
+    wram = wram_;
 }
 
 uint8_t Bus::read8(uint32_t addr) const {
+    GBA_PROF_ACCESS(addr, Read, W8);
+    return load8(addr);
+}
+
+uint8_t Bus::load8(uint32_t addr) const {
     if (addr >= VRAM_BASE && addr < VRAM_BASE + VRAM_SIZE) {
         uint32_t off = addr - VRAM_BASE;
         // Mode 3 VRAM is 16-bit aligned; allow byte fetch by reading the 16-bit pixel
@@ -27,24 +34,33 @@ uint8_t Bus::read8(uint32_t addr) const {
     if (addr >= WRAM_BASE && addr < WRAM_BASE + WRAM_SIZE) {
         return wram[addr - WRAM_BASE];
     }
+    if (addr >= SAVE_BASE && addr < SAVE_BASE + SAVE_SIZE) {
+        return cart ? cart->save.read8(addr - SAVE_BASE) : 0xFF;
+    }
     return 0; // default
 }
 
 uint16_t Bus::read16(uint32_t addr) const {
-    uint16_t lo = read8(addr);
-    uint16_t hi = read8(addr + 1);
+    GBA_PROF_ACCESS(addr, Read, W16);
+    if (addr >= EEPROM_BASE && addr < EEPROM_BASE + EEPROM_SIZE) {
+        return cart ? cart->save.eeprom_read() : 1;
+    }
+    uint16_t lo = load8(addr);
+    uint16_t hi = load8(addr + 1);
     return static_cast<uint16_t>(lo | (hi << 8));
 }
 
 uint32_t Bus::read32(uint32_t addr) const {
-    uint32_t b0 = read8(addr);
-    uint32_t b1 = read8(addr + 1);
-    uint32_t b2 = read8(addr + 2);
-    uint32_t b3 = read8(addr + 3);
+    GBA_PROF_ACCESS(addr, Read, W32);
+    uint32_t b0 = load8(addr);
+    uint32_t b1 = load8(addr + 1);
+    uint32_t b2 = load8(addr + 2);
+    uint32_t b3 = load8(addr + 3);
     return b0 | (b1 << 8) | (b2 << 16) | (b3 << 24);
 }
 
 void Bus::write8(uint32_t addr, uint8_t v) {
+    GBA_PROF_ACCESS(addr, Write, W8);
     if (addr >= VRAM_BASE && addr < VRAM_BASE + VRAM_SIZE) {
         if (!ppu) return;
         uint32_t off = addr - VRAM_BASE;
@@ -60,10 +76,19 @@ void Bus::write8(uint32_t addr, uint8_t v) {
         wram[addr - WRAM_BASE] = v;
         return;
     }
+    if (addr >= SAVE_BASE && addr < SAVE_BASE + SAVE_SIZE) {
+        if (cart) cart->save.write8(addr - SAVE_BASE, v);
+        return;
+    }
     // ignore
 }
 
 void Bus::write16(uint32_t addr, uint16_t v) {
+    GBA_PROF_ACCESS(addr, Write, W16);
+    store16(addr, v);
+}
+
+void Bus::store16(uint32_t addr, uint16_t v) {
     if (addr >= VRAM_BASE && addr < VRAM_BASE + VRAM_SIZE) {
         if (!ppu) return;
         uint32_t off = (addr - VRAM_BASE) >> 1;
@@ -78,11 +103,21 @@ void Bus::write16(uint32_t addr, uint16_t v) {
         }
         return;
     }
+    if (addr >= SAVE_BASE && addr < SAVE_BASE + SAVE_SIZE) {
+        // 8-bit bus: only the addressed byte lane is stored
+        if (cart) cart->save.write8(addr - SAVE_BASE, static_cast<uint8_t>(v >> (8 * (addr & 1))));
+        return;
+    }
+    if (addr >= EEPROM_BASE && addr < EEPROM_BASE + EEPROM_SIZE) {
+        if (cart) cart->save.eeprom_write(v);
+        return;
+    }
 }
 
 void Bus::write32(uint32_t addr, uint32_t v) {
-    write16(addr, static_cast<uint16_t>(v & 0xFFFF));
-    write16(addr + 2, static_cast<uint16_t>(v >> 16));
+    GBA_PROF_ACCESS(addr, Write, W32);
+    store16(addr, static_cast<uint16_t>(v & 0xFFFF));
+    store16(addr + 2, static_cast<uint16_t>(v >> 16));
 }
 
 }
@@ -1,6 +1,6 @@
 #pragma once
 #include <cstdint>
-#include <vector>
+#include <span>
 
 namespace gba {
 
@@ -15,9 +15,13 @@ struct Bus {
     static constexpr uint32_t ROM_SIZE  = 32 * 1024 * 1024; // up to 32MB window
     static constexpr uint32_t WRAM_BASE = 0x02000000;
     static constexpr uint32_t WRAM_SIZE = 256 * 1024;
+    static constexpr uint32_t EEPROM_BASE = 0x0D000000; // serial EEPROM port
+    static constexpr uint32_t EEPROM_SIZE = 0x01000000;
+    static constexpr uint32_t SAVE_BASE = 0x0E000000;   // SRAM / Flash
+    static constexpr uint32_t SAVE_SIZE = 64 * 1024;
 
-    // Connect components owned by GBA
-    void connect(PPU* ppu_, Cartridge* cart_);
+    // Connect components owned by GBA; `wram_` is a view into the GBA's MemoryArena
+    void connect(PPU* ppu_, Cartridge* cart_, std::span<uint8_t> wram_);
 
     // Basic memory accesses (little-endian)
     uint8_t  read8(uint32_t addr) const;
@@ -29,11 +33,15 @@ struct Bus {
     void write32(uint32_t addr, uint32_t v);
 
 private:
+    // Uncounted accessors shared by the width-specific entry points
+    uint8_t load8(uint32_t addr) const;
+    void store16(uint32_t addr, uint16_t v);
+
     PPU* ppu{nullptr};
     Cartridge* cart{nullptr};
 
-    // Minimal on-board work RAM
-    std::vector<uint8_t> wram = std::vector<uint8_t>(WRAM_SIZE);
+    // Minimal on-board work RAM (WRAM_SIZE bytes, owned by the arena)
+    std::span<uint8_t> wram;
 };
 
 }
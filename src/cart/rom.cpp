@@ -1,17 +1,34 @@
 #include "rom.hpp"
+#include "../mem/arena.hpp"
 #include <fstream>
+#include <cstring>
 
 namespace gba {
 
-bool Cartridge::load_from_file(const std::string& path) {
+bool Cartridge::load_from_file(const std::string& path, MemoryArena& arena) {
     std::ifstream f(path, std::ios::binary);
     if (!f) return false;
     f.seekg(0, std::ios::end);
     std::streamsize size = f.tellg();
     if (size <= 0) return false;
     f.seekg(0, std::ios::beg);
-    rom.resize(static_cast<size_t>(size));
-    if (!f.read(reinterpret_cast<char*>(rom.data()), size)) return false;
+    auto dst = arena.alloc_rom(static_cast<size_t>(size));
+    if (!f.read(reinterpret_cast<char*>(dst.data()), static_cast<std::streamsize>(dst.size()))) {
+        arena.alloc_rom(0);
+        rom = arena.rom();
+        return false;
+    }
+    arena.seal_rom();
+    rom = arena.rom();
+    return true;
+}
+
+bool Cartridge::load_from_bytes(std::span<const uint8_t> bytes, MemoryArena& arena) {
+    if (bytes.empty()) return false;
+    auto dst = arena.alloc_rom(bytes.size());
+    std::memcpy(dst.data(), bytes.data(), dst.size());
+    arena.seal_rom();
+    rom = arena.rom();
     return true;
 }
 
@@ -1,14 +1,22 @@
 #pragma once
 #include <cstdint>
-#include <vector>
+#include <span>
 #include <string>
+#include "save.hpp"
 
 namespace gba {
 
+struct MemoryArena; // fwd
+
 struct Cartridge {
-    std::vector<uint8_t> rom;
+    // View of the ROM bytes inside the GBA's MemoryArena
+    std::span<const uint8_t> rom;
+    // Backup memory (SRAM/Flash/EEPROM); SaveType::None until opened
+    SaveMemory save;
 
-    bool load_from_file(const std::string& path);
+    bool load_from_file(const std::string& path, MemoryArena& arena);
+    // Load an in-memory image (generated ROMs in tools and benchmarks)
+    bool load_from_bytes(std::span<const uint8_t> bytes, MemoryArena& arena);
 };
 
 }
@@ -0,0 +1,306 @@
+#include "save.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define GBA_SAVE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace gba {
+
+namespace {
+
+struct SaveId { const char* prefix; SaveType type; };
+
+// Longest prefixes first: "FLASH_V" must not shadow "FLASH512_V"
+const SaveId SAVE_IDS[] = {
+    {"FLASH1M_V", SaveType::Flash128K},
+    {"FLASH512_V", SaveType::Flash64K},
+    {"FLASH_V", SaveType::Flash64K},
+    {"SRAM_F_V", SaveType::Sram},
+    {"SRAM_V", SaveType::Sram},
+    {"EEPROM_V", SaveType::Eeprom8K},
+};
+
+const char* const SAVE_NAMES[] = {"none", "sram", "flash64", "flash128", "eeprom512", "eeprom8k"};
+
+// Flash chip IDs (manufacturer, device) reported in identification mode
+constexpr uint8_t FLASH64_ID[2] = {0x32, 0x1B};   // Panasonic MN63F805MNP
+constexpr uint8_t FLASH128_ID[2] = {0x62, 0x13};  // Sanyo LE26FV10N1TS
+
+constexpr uint32_t FLASH_SECTOR_BYTES = 4 * 1024;
+constexpr uint32_t EEPROM_READ_BITS = 4 + 64; // 4 junk bits, then the block
+
+}
+
+// --- Type detection ----------------------------------------------------------
+
+SaveType SaveMemory::detect(std::span<const uint8_t> rom) {
+    // The IDs are word aligned string constants
+    for (size_t i = 0; i + 4 <= rom.size(); i += 4) {
+        for (const auto& id : SAVE_IDS) {
+            size_t len = std::strlen(id.prefix);
+            if (i + len <= rom.size() && std::memcmp(&rom[i], id.prefix, len) == 0) return id.type;
+        }
+    }
+    return SaveType::None;
+}
+
+size_t SaveMemory::size_of(SaveType type) {
+    switch (type) {
+        case SaveType::Sram: return SRAM_BYTES;
+        case SaveType::Flash64K: return FLASH_BANK_BYTES;
+        case SaveType::Flash128K: return 2 * FLASH_BANK_BYTES;
+        case SaveType::Eeprom512: return 512;
+        case SaveType::Eeprom8K: return 8 * 1024;
+        default: return 0;
+    }
+}
+
+const char* SaveMemory::name(SaveType type) { return SAVE_NAMES[static_cast<size_t>(type)]; }
+
+bool SaveMemory::parse(const std::string& s, SaveType& type) {
+    for (size_t i = 0; i < std::size(SAVE_NAMES); ++i) {
+        if (s == SAVE_NAMES[i]) { type = static_cast<SaveType>(i); return true; }
+    }
+    return false;
+}
+
+// --- Backing store -----------------------------------------------------------
+
+bool SaveMemory::open(const std::string& file, SaveType type, std::chrono::milliseconds flush_interval) {
+    close();
+    if (type == SaveType::None) return true;
+
+#if GBA_SAVE_MMAP
+    int fd = ::open(file.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) return false;
+    struct stat st{};
+    if (::fstat(fd, &st) != 0) { ::close(fd); return false; }
+    size_t existing = static_cast<size_t>(st.st_size);
+    if (type == SaveType::Eeprom8K && existing == size_of(SaveType::Eeprom512)) type = SaveType::Eeprom512;
+    size_t size = size_of(type);
+    // Grow short files; never truncate a longer one (another emulator's layout)
+    if (existing < size && ::ftruncate(fd, static_cast<off_t>(size)) != 0) { ::close(fd); return false; }
+    void* p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd); // the mapping keeps the file referenced
+    if (p == MAP_FAILED) return false;
+    map = p;
+    data = {static_cast<uint8_t*>(p), size};
+    if (existing < size) {
+        std::fill(data.begin() + static_cast<std::ptrdiff_t>(existing), data.end(), uint8_t{0xFF});
+        dirty.store(true, std::memory_order_relaxed);
+    }
+#else
+    std::vector<uint8_t> contents;
+    if (std::FILE* f = std::fopen(file.c_str(), "rb")) {
+        uint8_t chunk[4096];
+        size_t n;
+        while ((n = std::fread(chunk, 1, sizeof(chunk), f)) > 0) contents.insert(contents.end(), chunk, chunk + n);
+        std::fclose(f);
+    }
+    if (type == SaveType::Eeprom8K && contents.size() == size_of(SaveType::Eeprom512)) type = SaveType::Eeprom512;
+    size_t size = size_of(type);
+    bool fresh = contents.size() < size;
+    contents.resize(size, 0xFF);
+    heap = std::move(contents);
+    data = heap;
+    dirty.store(fresh, std::memory_order_relaxed);
+#endif
+
+    kind = type;
+    path = file;
+    interval = flush_interval;
+#if GBA_SAVE_MMAP
+    stopping = false;
+    flusher = std::thread(&SaveMemory::flusher_loop, this);
+#endif
+    return true;
+}
+
+void SaveMemory::open_anonymous(SaveType type, std::span<uint8_t> storage) {
+    attach(type, storage);
+    std::fill(data.begin(), data.end(), uint8_t{0xFF});
+}
+
+void SaveMemory::attach(SaveType type, std::span<uint8_t> storage) {
+    close();
+    data = storage.first(size_of(type));
+    kind = type;
+}
+
+bool SaveMemory::flush() {
+    if (path.empty() || !dirty.load(std::memory_order_relaxed)) return true;
+    std::lock_guard<std::mutex> lock(io);
+    // Clear first: a store landing during the sync re-marks the data dirty
+    if (!dirty.exchange(false, std::memory_order_acq_rel)) return true;
+    flush_count.fetch_add(1, std::memory_order_relaxed);
+#if GBA_SAVE_MMAP
+    if (::msync(map, data.size(), MS_SYNC) == 0) return true;
+#else
+    if (std::FILE* f = std::fopen(path.c_str(), "wb")) {
+        bool ok = std::fwrite(data.data(), 1, data.size(), f) == data.size();
+        ok = std::fclose(f) == 0 && ok;
+        if (ok) return true;
+    }
+#endif
+    mark_dirty(); // retry on the next flush
+    return false;
+}
+
+void SaveMemory::flusher_loop() {
+    std::unique_lock<std::mutex> lock(mtx);
+    while (!stopping) {
+        cv.wait_for(lock, interval, [&] { return stopping; });
+        lock.unlock();
+        flush();
+        lock.lock();
+    }
+}
+
+void SaveMemory::close() {
+    if (flusher.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            stopping = true;
+        }
+        cv.notify_all();
+        flusher.join();
+    }
+    flush();
+#if GBA_SAVE_MMAP
+    if (map) ::munmap(map, data.size());
+#endif
+    map = nullptr;
+    data = {};
+    heap.clear();
+    path.clear();
+    kind = SaveType::None;
+    dirty.store(false, std::memory_order_relaxed);
+    proto = Protocol{};
+}
+
+// --- Flash -------------------------------------------------------------------
+
+uint8_t SaveMemory::flash_read(uint32_t off) const {
+    off &= FLASH_BANK_BYTES - 1;
+    if (proto.flash_id && off < 2) return (kind == SaveType::Flash128K ? FLASH128_ID : FLASH64_ID)[off];
+    return data[proto.flash_bank + off];
+}
+
+void SaveMemory::flash_write(uint32_t off, uint8_t v) {
+    off &= FLASH_BANK_BYTES - 1;
+    if (proto.flash_mode == FlashMode::Program) {
+        data[proto.flash_bank + off] = v;
+        mark_dirty();
+        proto.flash_mode = FlashMode::Ready;
+        return;
+    }
+    if (proto.flash_mode == FlashMode::Bank) {
+        if (off == 0) proto.flash_bank = (v & 1) * FLASH_BANK_BYTES;
+        proto.flash_mode = FlashMode::Ready;
+        return;
+    }
+
+    switch (proto.flash_stage) {
+        case 0:
+            if (off == 0x5555 && v == 0xAA) proto.flash_stage = 1;
+            else if (v == 0xF0) proto.flash_id = false; // reset also works unprefixed
+            return;
+        case 1:
+            proto.flash_stage = (off == 0x2AAA && v == 0x55) ? 2 : 0;
+            return;
+        default:
+            break;
+    }
+    proto.flash_stage = 0;
+
+    if (proto.flash_erase) {
+        proto.flash_erase = false;
+        if (off == 0x5555 && v == 0x10) {
+            std::fill(data.begin(), data.end(), uint8_t{0xFF});
+            mark_dirty();
+        } else if (v == 0x30) {
+            auto sector = data.begin() + static_cast<std::ptrdiff_t>(proto.flash_bank + (off & ~(FLASH_SECTOR_BYTES - 1)));
+            std::fill(sector, sector + FLASH_SECTOR_BYTES, uint8_t{0xFF});
+            mark_dirty();
+        }
+        return;
+    }
+    if (off != 0x5555) return;
+    switch (v) {
+        case 0x90: proto.flash_id = true; break;
+        case 0xF0: proto.flash_id = false; break;
+        case 0x80: proto.flash_erase = true; break;
+        case 0xA0: proto.flash_mode = FlashMode::Program; break;
+        case 0xB0: if (kind == SaveType::Flash128K) proto.flash_mode = FlashMode::Bank; break;
+        default: break;
+    }
+}
+
+// --- EEPROM ------------------------------------------------------------------
+//
+// Requests are sent MSB first, one bit per halfword:
+//   read:  1 1 <address> 0            then 68 bits are read back
+//   write: 1 0 <address> <64 bits> 0
+// The address selects an 8-byte block. Outside a read the port returns 1 (ready).
+
+uint16_t SaveMemory::eeprom_read() {
+    if (proto.eep_state != EepromState::Reading) return 1;
+    uint32_t pos = proto.eep_bits++;
+    if (proto.eep_bits == EEPROM_READ_BITS) {
+        proto.eep_state = EepromState::Command;
+        proto.eep_bits = 0;
+    }
+    if (pos < 4) return 0;
+    pos -= 4;
+    return (data[proto.eep_addr * 8 + pos / 8] >> (7 - pos % 8)) & 1;
+}
+
+void SaveMemory::eeprom_write(uint16_t v) {
+    if (kind != SaveType::Eeprom512 && kind != SaveType::Eeprom8K) return;
+    uint32_t bit = v & 1;
+    switch (proto.eep_state) {
+        case EepromState::Reading: // a new request abandons an unfinished read
+            proto.eep_state = EepromState::Command;
+            proto.eep_bits = 0;
+            [[fallthrough]];
+        case EepromState::Command:
+            if (proto.eep_bits == 0) {
+                if (bit) proto.eep_bits = 1; // every request starts with a 1
+                return;
+            }
+            proto.eep_writing = bit == 0;
+            proto.eep_state = EepromState::Address;
+            proto.eep_bits = 0;
+            proto.eep_addr = 0;
+            return;
+        case EepromState::Address:
+            proto.eep_addr = (proto.eep_addr << 1) | bit;
+            if (++proto.eep_bits < eeprom_addr_bits()) return;
+            proto.eep_addr &= static_cast<uint32_t>(data.size() / 8 - 1);
+            proto.eep_bits = 0;
+            proto.eep_buffer = 0;
+            proto.eep_state = proto.eep_writing ? EepromState::Data : EepromState::End;
+            return;
+        case EepromState::Data:
+            proto.eep_buffer = (proto.eep_buffer << 1) | bit;
+            if (++proto.eep_bits < 64) return;
+            for (int i = 0; i < 8; ++i) data[proto.eep_addr * 8 + i] = static_cast<uint8_t>(proto.eep_buffer >> (56 - 8 * i));
+            mark_dirty();
+            proto.eep_bits = 0;
+            proto.eep_state = EepromState::End;
+            return;
+        case EepromState::End:
+            proto.eep_bits = 0;
+            proto.eep_state = proto.eep_writing ? EepromState::Command : EepromState::Reading;
+            return;
+    }
+}
+
+}
@@ -0,0 +1,145 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace gba {
+
+enum class SaveType : uint8_t {
+    None,
+    Sram,       // 32KB battery-backed SRAM, byte access at 0x0E000000
+    Flash64K,   // 64KB Flash with command protocol at 0x0E000000
+    Flash128K,  // two 64KB Flash banks
+    Eeprom512,  // 512B serial EEPROM at 0x0D000000, 6-bit addresses
+    Eeprom8K,   // 8KB serial EEPROM, 14-bit addresses
+};
+
+// Cartridge backup memory.
+//
+// The contents live in a shared mapping of the save file, so stores from the
+// Bus are plain memory writes plus a relaxed dirty flag. A background thread
+// msyncs the mapping at most every flush interval while it is dirty; close()
+// (and the destructor) does a final synchronous flush. Where mmap is not
+// available the contents are kept on the heap and written back only by
+// flush()/close(). Saves without a file live in storage owned by the caller
+// (the GBA's MemoryArena), so snapshots share them copy-on-write like RAM.
+struct SaveMemory {
+    static constexpr std::chrono::milliseconds DEFAULT_FLUSH_INTERVAL{500};
+    static constexpr size_t MAX_BYTES = 128 * 1024; // Flash128K, the largest
+
+    enum class FlashMode : uint8_t { Ready, Program, Bank };
+    enum class EepromState : uint8_t { Command, Address, Data, End, Reading };
+
+    // Flash command and EEPROM serial state between bus accesses; carried by
+    // snapshots so a clone taken mid-command continues it
+    struct Protocol {
+        FlashMode flash_mode{FlashMode::Ready};
+        uint8_t flash_stage{0};      // position in the AA/55 unlock sequence
+        bool flash_id{false};        // chip identification mode
+        bool flash_erase{false};     // 0x80 seen, next command erases
+        uint32_t flash_bank{0};      // byte offset of the selected bank
+        EepromState eep_state{EepromState::Command};
+        bool eep_writing{false};
+        uint32_t eep_bits{0};        // bits received in the current state
+        uint32_t eep_addr{0};
+        uint64_t eep_buffer{0};
+    };
+
+    // Look for the library ID strings ("SRAM_V", "FLASH1M_V", "EEPROM_V", ...)
+    // that games built with the official SDK carry in their ROM. EEPROM size
+    // cannot be told from the ROM; Eeprom8K is assumed.
+    static SaveType detect(std::span<const uint8_t> rom);
+    static size_t size_of(SaveType type);
+    static const char* name(SaveType type);
+    // Inverse of name(); false for an unknown string
+    static bool parse(const std::string& s, SaveType& type);
+
+    SaveMemory() = default;
+    ~SaveMemory() { close(); }
+    SaveMemory(const SaveMemory&) = delete;
+    SaveMemory& operator=(const SaveMemory&) = delete;
+
+    // Map `path` as the backing store, creating it (erased to 0xFF) when
+    // missing or short. An existing 512-byte file turns Eeprom8K into Eeprom512.
+    bool open(const std::string& path, SaveType type,
+              std::chrono::milliseconds flush_interval = DEFAULT_FLUSH_INTERVAL);
+    // Volatile contents with no file, erased to 0xFF, in `storage` (at least
+    // size_of(type) bytes that outlive the save)
+    void open_anonymous(SaveType type, std::span<uint8_t> storage);
+    // Like open_anonymous() but keeps what `storage` holds (spawned machines)
+    void attach(SaveType type, std::span<uint8_t> storage);
+    // Follow storage that moved; no-op for file-backed saves
+    void rebind(std::span<uint8_t> storage) {
+        if (path.empty() && kind != SaveType::None) data = storage.first(data.size());
+    }
+    // Final flush, stop the flush thread and unmap
+    void close();
+    // Write dirty contents back now; false on I/O error
+    bool flush();
+
+    SaveType type() const { return kind; }
+    bool is_file_backed() const { return !path.empty(); }
+    std::span<const uint8_t> bytes() const { return data; }
+    const Protocol& protocol() const { return proto; }
+    // Resume a command in progress (spawning from a snapshot)
+    void restore(const Protocol& state) { proto = state; }
+    // Number of flushes that found dirty data (all threads)
+    uint64_t flushes() const { return flush_count.load(std::memory_order_relaxed); }
+
+    // Bus side, 0x0E000000 window (SRAM / Flash); `off` is relative to it
+    uint8_t read8(uint32_t off) const {
+        if (kind == SaveType::Sram) return data[off & (SRAM_BYTES - 1)];
+        if (kind == SaveType::Flash64K || kind == SaveType::Flash128K) return flash_read(off);
+        return 0xFF;
+    }
+    void write8(uint32_t off, uint8_t v) {
+        if (kind == SaveType::Sram) {
+            data[off & (SRAM_BYTES - 1)] = v;
+            mark_dirty();
+            return;
+        }
+        if (kind == SaveType::Flash64K || kind == SaveType::Flash128K) flash_write(off, v);
+    }
+
+    // EEPROM serial port, 0x0D000000 window: one bit (bit 0) per 16-bit access
+    uint16_t eeprom_read();
+    void eeprom_write(uint16_t v);
+
+private:
+    static constexpr uint32_t SRAM_BYTES = 32 * 1024;
+    static constexpr uint32_t FLASH_BANK_BYTES = 64 * 1024;
+
+    SaveType kind{SaveType::None};
+    std::span<uint8_t> data;
+    std::vector<uint8_t> heap;  // no-mmap file backing
+    void* map{nullptr};
+    std::string path;
+
+    // A plain byte store on x86/ARM: the flush thread clears it before syncing,
+    // so a store racing with a flush is picked up by the next one
+    std::atomic<bool> dirty{false};
+    std::atomic<uint64_t> flush_count{0};
+    void mark_dirty() { dirty.store(true, std::memory_order_relaxed); }
+
+    std::thread flusher;
+    std::mutex mtx;              // guards `stopping`
+    std::condition_variable cv;
+    bool stopping{false};
+    std::mutex io;               // serializes flushes from both threads
+    std::chrono::milliseconds interval{DEFAULT_FLUSH_INTERVAL};
+    void flusher_loop();
+
+    Protocol proto;
+    uint8_t flash_read(uint32_t off) const;
+    void flash_write(uint32_t off, uint8_t v);
+
+    uint32_t eeprom_addr_bits() const { return kind == SaveType::Eeprom512 ? 6 : 14; }
+};
+
+}
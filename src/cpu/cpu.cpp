@@ -1,5 +1,7 @@
 #include "cpu.hpp"
 #include "../bus/bus.hpp"
+#include "../debug/profiler.hpp"
+#include "../debug/trace.hpp"
 
 namespace gba {
 
@@ -148,7 +150,7 @@ void CPU::exec_thumb(uint16_t op) {
     }
 
     // MOV/CMP/ADD/SUB immediate
-    if ((op & 0xE000) == 0x2000) {
+    if ((op & 0xF800) == 0x2000) {
         // MOV Rd, #imm8
         uint32_t rd = (op >> 8) & 0x7;
         uint32_t imm8 = op & 0xFF;
@@ -300,10 +302,49 @@ void CPU::exec_thumb(uint16_t op) {
     // Unknown/unsupported: do nothing
 }
 
+#if GBAEMU_PROFILE
+// Mirrors the decode order of exec_thumb
+static prof::OpClass thumb_op_class(uint16_t op) {
+    using prof::OpClass;
+    switch (op & 0xF800) {
+        case 0x0000: case 0x0800: case 0x1000: return OpClass::ShiftImm;
+        case 0x2000: return OpClass::MovImm;
+        case 0x2800: return OpClass::CmpImm;
+        case 0x3000: return OpClass::AddImm;
+        case 0x3800: return OpClass::SubImm;
+        case 0x4800: return OpClass::LdrLiteral;
+        case 0x6000: return OpClass::StrWord;
+        case 0x6800: return OpClass::LdrWord;
+        case 0x7000: return OpClass::StrByte;
+        case 0x7800: return OpClass::LdrByte;
+        case 0x8000: return OpClass::StrHalf;
+        case 0x8800: return OpClass::LdrHalf;
+        case 0xA000: return OpClass::AddPc;
+        case 0xE000: return OpClass::Branch;
+        default: break;
+    }
+    if ((op & 0xFC00) == 0x4000) return OpClass::AluReg;
+    if ((op & 0xF000) == 0xD000) return ((op & 0x0F00) == 0x0F00) ? OpClass::Swi : OpClass::CondBranch;
+    return OpClass::Unhandled;
+}
+#endif
+
+void CPU::record_trace(uint32_t pc, uint16_t op) {
+    trace->record(pc, op, r, cpsr);
+}
+
 void CPU::step() {
+    const uint32_t pc = r[PC];
+#if GBAEMU_PROFILE
+    uint64_t t0 = GBA_PROF_TIMESTAMP();
+#endif
     // For now assume Thumb mode; fetch and execute one halfword
     uint16_t op = fetch16_pc();
     exec_thumb(op);
+    if (trace) [[unlikely]] record_trace(pc, op);
+#if GBAEMU_PROFILE
+    GBA_PROF_OP(thumb_op_class(op), pc, GBA_PROF_TIMESTAMP() - t0);
+#endif
 }
 
 }
@@ -4,6 +4,7 @@
 namespace gba {
 
 struct Bus; // fwd
+struct TraceWriter; // fwd
 
 struct CPU {
     // ARM7TDMI (Thumb-first subset)
@@ -20,11 +21,14 @@ struct CPU {
     uint32_t cpsr{};  // flags + T bit, etc.
 
     void attach_bus(Bus* b) { bus = b; }
+    // Record every executed instruction (nullptr to stop); the writer must be open
+    void attach_trace(TraceWriter* t) { trace = t; }
     void reset();
     void step(); // executes one Thumb instruction for now
 
 private:
     Bus* bus{nullptr};
+    TraceWriter* trace{nullptr};
 
     // Thumb helpers
     uint16_t fetch16(uint32_t addr) const;
@@ -61,6 +65,7 @@ private:
 
     // Execute
     void exec_thumb(uint16_t op);
+    void record_trace(uint32_t pc, uint16_t op); // out of line: keeps step() small
     uint32_t lsl_c(uint32_t value, uint32_t amount, bool& c_out) const;
     uint32_t lsr_c(uint32_t value, uint32_t amount, bool& c_out) const;
     uint32_t asr_c(uint32_t value, uint32_t amount, bool& c_out) const;
@@ -0,0 +1,164 @@
+#include "profiler.hpp"
+
+#if GBAEMU_PROFILE
+
+#include "../bus/bus.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define GBA_PROF_HAVE_RDTSC 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define GBA_PROF_HAVE_RDTSC 1
+#endif
+
+namespace gba::prof {
+
+namespace {
+
+constexpr size_t OP_CLASSES = static_cast<size_t>(OpClass::Count);
+constexpr size_t REGIONS = static_cast<size_t>(Region::Count);
+constexpr size_t ACCESSES = static_cast<size_t>(Access::Count);
+constexpr size_t WIDTHS = static_cast<size_t>(Width::Count);
+
+const char* const OP_NAMES[OP_CLASSES] = {
+    "shift_imm", "mov_imm", "cmp_imm", "add_imm", "sub_imm", "alu_reg", "ldr_literal",
+    "str_word", "ldr_word", "str_byte", "ldr_byte", "str_half", "ldr_half",
+    "add_pc", "cond_branch", "swi", "branch", "unhandled",
+};
+const char* const REGION_NAMES[REGIONS] = {"wram", "vram", "rom", "save", "unmapped"};
+const char* const ACCESS_NAMES[ACCESSES] = {"read", "write"};
+const char* const WIDTH_NAMES[WIDTHS] = {"8", "16", "32"};
+
+Region region_of(uint32_t addr) {
+    if (addr >= Bus::WRAM_BASE && addr < Bus::WRAM_BASE + Bus::WRAM_SIZE) return Region::WRAM;
+    if (addr >= Bus::VRAM_BASE && addr < Bus::VRAM_BASE + Bus::VRAM_SIZE) return Region::VRAM;
+    if (addr >= Bus::ROM_BASE && addr < Bus::ROM_BASE + Bus::ROM_SIZE) return Region::ROM;
+    if (addr >= Bus::EEPROM_BASE && addr < Bus::SAVE_BASE + Bus::SAVE_SIZE) return Region::Save;
+    return Region::Unmapped;
+}
+
+struct Profile {
+    uint64_t ops[OP_CLASSES]{};
+    uint64_t op_cycles[OP_CLASSES]{};
+    uint64_t accesses[REGIONS][ACCESSES][WIDTHS]{};
+    uint64_t instructions{0};
+    std::unordered_map<uint32_t, uint64_t> hot_pcs;
+    uint32_t sample_countdown{1};
+    uint32_t sample_rng{0x9E3779B9u};
+
+    // Uniform in [1, 2 * HOT_PC_SAMPLE_INTERVAL - 1] (xorshift32)
+    uint32_t next_sample_gap() {
+        sample_rng ^= sample_rng << 13;
+        sample_rng ^= sample_rng >> 17;
+        sample_rng ^= sample_rng << 5;
+        return 1 + sample_rng % (2 * HOT_PC_SAMPLE_INTERVAL - 1);
+    }
+
+    ~Profile() { report(); }
+
+    void report() const {
+        if (instructions == 0) return;
+        std::FILE* out = stderr;
+        const char* path = std::getenv("GBAEMU_PROFILE_OUT");
+        if (path && *path) {
+            if (std::FILE* f = std::fopen(path, "w")) out = f;
+        }
+
+        std::fprintf(out, "=== gbaemu profile: %llu instructions ===\n",
+            static_cast<unsigned long long>(instructions));
+
+        std::vector<size_t> order(OP_CLASSES);
+        for (size_t i = 0; i < OP_CLASSES; ++i) order[i] = i;
+        std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return ops[a] > ops[b]; });
+        uint64_t total_cycles = 0;
+        for (uint64_t c : op_cycles) total_cycles += c;
+        std::fprintf(out, "\n-- opcode classes --\n%-14s %14s %8s", "class", "count", "%");
+        if (GBAEMU_PROFILE_CYCLES) std::fprintf(out, " %14s %8s %10s", "host_cycles", "%", "cyc/op");
+        std::fprintf(out, "\n");
+        for (size_t i : order) {
+            if (!ops[i]) continue;
+            std::fprintf(out, "%-14s %14llu %7.2f%%", OP_NAMES[i],
+                static_cast<unsigned long long>(ops[i]), 100.0 * ops[i] / instructions);
+            if (GBAEMU_PROFILE_CYCLES) {
+                std::fprintf(out, " %14llu %7.2f%% %10.1f",
+                    static_cast<unsigned long long>(op_cycles[i]),
+                    total_cycles ? 100.0 * op_cycles[i] / total_cycles : 0.0,
+                    static_cast<double>(op_cycles[i]) / ops[i]);
+            }
+            std::fprintf(out, "\n");
+        }
+
+        struct Row { size_t region, access, width; uint64_t count; };
+        std::vector<Row> rows;
+        uint64_t total_accesses = 0;
+        for (size_t r = 0; r < REGIONS; ++r)
+            for (size_t a = 0; a < ACCESSES; ++a)
+                for (size_t w = 0; w < WIDTHS; ++w)
+                    if (accesses[r][a][w]) {
+                        rows.push_back({r, a, w, accesses[r][a][w]});
+                        total_accesses += accesses[r][a][w];
+                    }
+        std::sort(rows.begin(), rows.end(), [](const Row& a, const Row& b) { return a.count > b.count; });
+        std::fprintf(out, "\n-- bus accesses (includes instruction fetches) --\n%-10s %-6s %-5s %14s %8s\n",
+            "region", "access", "width", "count", "%");
+        for (const auto& row : rows) {
+            std::fprintf(out, "%-10s %-6s %-5s %14llu %7.2f%%\n",
+                REGION_NAMES[row.region], ACCESS_NAMES[row.access], WIDTH_NAMES[row.width],
+                static_cast<unsigned long long>(row.count), 100.0 * row.count / total_accesses);
+        }
+
+        std::vector<std::pair<uint32_t, uint64_t>> pcs(hot_pcs.begin(), hot_pcs.end());
+        std::sort(pcs.begin(), pcs.end(), [](const auto& a, const auto& b) {
+            return a.second != b.second ? a.second > b.second : a.first < b.first;
+        });
+        uint64_t samples = 0;
+        for (const auto& p : pcs) samples += p.second;
+        std::fprintf(out, "\n-- hot PCs (about 1 in %u instructions sampled, top 20) --\n%-10s %10s %8s\n",
+            HOT_PC_SAMPLE_INTERVAL, "pc", "samples", "%");
+        for (size_t i = 0; i < pcs.size() && i < 20; ++i) {
+            std::fprintf(out, "0x%08x %10llu %7.2f%%\n", pcs[i].first,
+                static_cast<unsigned long long>(pcs[i].second), 100.0 * pcs[i].second / samples);
+        }
+
+        if (out != stderr) std::fclose(out);
+    }
+};
+
+Profile profile;
+
+}
+
+uint64_t timestamp() {
+#ifdef GBA_PROF_HAVE_RDTSC
+    return __rdtsc();
+#else
+    return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+
+void count_op(OpClass cls, uint32_t pc, uint64_t host_cycles) {
+    size_t i = static_cast<size_t>(cls);
+    profile.ops[i]++;
+    profile.op_cycles[i] += host_cycles;
+    profile.instructions++;
+    if (--profile.sample_countdown == 0) {
+        profile.hot_pcs[pc]++;
+        profile.sample_countdown = profile.next_sample_gap();
+    }
+}
+
+void count_access(uint32_t addr, Access access, Width width) {
+    profile.accesses[static_cast<size_t>(region_of(addr))][static_cast<size_t>(access)][static_cast<size_t>(width)]++;
+}
+
+}
+
+#endif
@@ -0,0 +1,58 @@
+#pragma once
+#include <cstdint>
+
+// Execution profiler, enabled at configure time with -DGBAEMU_PROFILE=ON
+// (and -DGBAEMU_PROFILE_CYCLES=ON for host-cycle attribution). When disabled,
+// the GBA_PROF_* hooks expand to nothing and no profiler code is built.
+//
+// Counters are process-wide (all GBA instances add up) and a sorted report is
+// printed to stderr at exit, or to the file named by $GBAEMU_PROFILE_OUT.
+
+#ifndef GBAEMU_PROFILE
+#define GBAEMU_PROFILE 0
+#endif
+#ifndef GBAEMU_PROFILE_CYCLES
+#define GBAEMU_PROFILE_CYCLES 0
+#endif
+
+namespace gba::prof {
+
+// Thumb decode classes, in CPU::exec_thumb order
+enum class OpClass : uint8_t {
+    ShiftImm, MovImm, CmpImm, AddImm, SubImm, AluReg, LdrLiteral,
+    StrWord, LdrWord, StrByte, LdrByte, StrHalf, LdrHalf,
+    AddPc, CondBranch, Swi, Branch, Unhandled,
+    Count
+};
+
+enum class Region : uint8_t { WRAM, VRAM, ROM, Save, Unmapped, Count };
+enum class Access : uint8_t { Read, Write, Count };
+enum class Width : uint8_t { W8, W16, W32, Count };
+
+// Sample the PC on average once every HOT_PC_SAMPLE_INTERVAL instructions. The
+// gap is drawn at random each time: a fixed one aliases with any loop whose
+// length divides it and piles every sample onto one PC.
+inline constexpr uint32_t HOT_PC_SAMPLE_INTERVAL = 256;
+
+#if GBAEMU_PROFILE
+uint64_t timestamp();                        // rdtsc, or steady_clock ns off x86
+void count_op(OpClass cls, uint32_t pc, uint64_t host_cycles);
+void count_access(uint32_t addr, Access access, Width width);
+#endif
+
+}
+
+#if GBAEMU_PROFILE
+#if GBAEMU_PROFILE_CYCLES
+#define GBA_PROF_TIMESTAMP() ::gba::prof::timestamp()
+#else
+#define GBA_PROF_TIMESTAMP() uint64_t{0}
+#endif
+#define GBA_PROF_OP(cls, pc, cycles) ::gba::prof::count_op((cls), (pc), (cycles))
+#define GBA_PROF_ACCESS(addr, access, width) \
+    ::gba::prof::count_access((addr), ::gba::prof::Access::access, ::gba::prof::Width::width)
+#else
+#define GBA_PROF_TIMESTAMP() uint64_t{0}
+#define GBA_PROF_OP(cls, pc, cycles) ((void)0)
+#define GBA_PROF_ACCESS(addr, access, width) ((void)0)
+#endif
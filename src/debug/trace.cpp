@@ -0,0 +1,211 @@
+#include "trace.hpp"
+#include <bit>
+
+namespace gba {
+
+static constexpr size_t HEADER_BYTES = sizeof(TRACE_MAGIC) + 4 + 16 * 4 + 4;
+
+// --- TraceWriter -------------------------------------------------------------
+
+bool TraceWriter::open(const std::string& path, const uint32_t (&regs)[16], uint32_t cpsr) {
+    close();
+    file = std::fopen(path.c_str(), "wb");
+    if (!file) return false;
+
+    uint8_t header[HEADER_BYTES];
+    uint8_t* p = header;
+    std::memcpy(p, TRACE_MAGIC, sizeof(TRACE_MAGIC)); p += sizeof(TRACE_MAGIC);
+    std::memcpy(p, &TRACE_VERSION, 4); p += 4;
+    std::memcpy(p, regs, 16 * 4); p += 16 * 4;
+    std::memcpy(p, &cpsr, 4);
+    if (std::fwrite(header, 1, HEADER_BYTES, file) != HEADER_BYTES) {
+        std::fclose(file);
+        file = nullptr;
+        return false;
+    }
+
+    for (auto& page : pages) page.resize(PAGE_BYTES);
+    active = 0;
+    cur = pages[0].data();
+    end = cur + PAGE_BYTES;
+    next_pc = regs[15];
+    std::memcpy(prev, regs, sizeof(prev));
+    prev_cpsr = cpsr;
+    count = 0;
+    written = HEADER_BYTES;
+    pending = nullptr;
+    stopping = false;
+    failed = false;
+    worker = std::thread(&TraceWriter::writer_loop, this);
+    return true;
+}
+
+void TraceWriter::close() {
+    if (!file) return;
+    if (cur != pages[active].data()) swap_pages();
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        stopping = true;
+    }
+    cv.notify_all();
+    worker.join();
+    std::fclose(file);
+    file = nullptr;
+    cur = end = nullptr;
+}
+
+void TraceWriter::record_multi(uint32_t pc, uint16_t opcode, uint32_t mask, const uint32_t (&regs)[16], uint32_t cpsr) {
+    uint8_t* p = cur;
+    uint8_t* flags = p++;
+    uint8_t f = 0;
+    std::memcpy(p, &opcode, 2); p += 2;
+    if (pc != next_pc) { std::memcpy(p, &pc, 4); p += 4; f |= TRACE_PC; }
+    f |= TRACE_REG | TRACE_REG_MULTI << TRACE_REG_SHIFT;
+    uint16_t m16 = static_cast<uint16_t>(mask);
+    std::memcpy(p, &m16, 2); p += 2;
+    for (uint32_t m = mask; m; m &= m - 1) {
+        std::memcpy(p, &regs[std::countr_zero(m)], 4); p += 4;
+    }
+    if ((cpsr ^ prev_cpsr) & ~TRACE_NZCV_MASK) {
+        std::memcpy(p, &cpsr, 4); p += 4; f |= TRACE_CPSR;
+    } else if (cpsr != prev_cpsr) {
+        *p++ = static_cast<uint8_t>(cpsr >> 28); f |= TRACE_NZCV;
+    }
+    *flags = f;
+    cur = p;
+    std::memcpy(prev, regs, sizeof(prev));
+    prev_cpsr = cpsr;
+    next_pc = pc + 2;
+    ++count;
+}
+
+void TraceWriter::swap_pages() {
+    size_t size = static_cast<size_t>(cur - pages[active].data());
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        // The writer still owns the other page: the disk is a full page behind
+        cv.wait(lock, [&] { return pending == nullptr; });
+        pending = pages[active].data();
+        pending_size = size;
+    }
+    cv.notify_all();
+    active ^= 1;
+    cur = pages[active].data();
+    end = cur + PAGE_BYTES;
+}
+
+void TraceWriter::writer_loop() {
+    std::unique_lock<std::mutex> lock(mtx);
+    for (;;) {
+        cv.wait(lock, [&] { return pending != nullptr || stopping; });
+        if (!pending) break; // stopping with nothing left
+        const uint8_t* data = pending;
+        size_t size = pending_size;
+        lock.unlock();
+        bool ok = std::fwrite(data, 1, size, file) == size;
+        lock.lock();
+        if (!ok) failed = true;
+        written += size;
+        pending = nullptr;
+        cv.notify_all();
+    }
+}
+
+// --- TraceReader -------------------------------------------------------------
+
+bool TraceReader::open(const std::string& path) {
+    close();
+    file = std::fopen(path.c_str(), "rb");
+    if (!file) return false;
+
+    uint8_t header[HEADER_BYTES];
+    uint32_t version = 0;
+    if (std::fread(header, 1, HEADER_BYTES, file) != HEADER_BYTES ||
+        std::memcmp(header, TRACE_MAGIC, sizeof(TRACE_MAGIC)) != 0) {
+        close();
+        return false;
+    }
+    std::memcpy(&version, header + 8, 4);
+    if (version != TRACE_VERSION) {
+        close();
+        return false;
+    }
+    start = TraceRecord{};
+    std::memcpy(start.r, header + 12, 16 * 4);
+    std::memcpy(&start.cpsr, header + 12 + 16 * 4, 4);
+    start.pc = start.r[15];
+    state = start;
+    next_pc = start.r[15];
+    index = 0;
+    buf.resize(1u << 20);
+    pos = len = 0;
+    bad = false;
+    return true;
+}
+
+void TraceReader::close() {
+    if (file) std::fclose(file);
+    file = nullptr;
+}
+
+bool TraceReader::fill(size_t need) {
+    if (len - pos >= need) return true;
+    std::memmove(buf.data(), buf.data() + pos, len - pos);
+    len -= pos;
+    pos = 0;
+    if (file) len += std::fread(buf.data() + len, 1, buf.size() - len, file);
+    return len - pos >= need;
+}
+
+bool TraceReader::next(TraceRecord& rec) {
+    if (!file || bad) return false;
+    fill(TraceWriter::MAX_RECORD);
+    if (pos == len) return false; // clean end
+
+    auto need = [&](size_t n) { if (len - pos < n) { bad = true; return false; } return true; };
+    if (!need(3)) return false;
+    uint8_t flags = buf[pos++];
+    uint16_t op;
+    std::memcpy(&op, &buf[pos], 2); pos += 2;
+
+    uint32_t pc = next_pc;
+    if (flags & TRACE_PC) {
+        if (!need(4)) return false;
+        std::memcpy(&pc, &buf[pos], 4); pos += 4;
+    }
+    auto get32 = [&](uint32_t& v) {
+        if (!need(4)) return false;
+        std::memcpy(&v, &buf[pos], 4); pos += 4;
+        return true;
+    };
+    uint16_t mask = 0;
+    uint32_t reg = flags >> TRACE_REG_SHIFT;
+    if ((flags & TRACE_REG) && reg != TRACE_REG_MULTI) {
+        if (!get32(state.r[reg])) return false;
+        mask = static_cast<uint16_t>(1u << reg);
+    } else if (flags & TRACE_REG) {
+        if (!need(2)) return false;
+        std::memcpy(&mask, &buf[pos], 2); pos += 2;
+        mask &= 0x7FFF;
+        for (int i = 0; i < 15; ++i) {
+            if ((mask & (1u << i)) && !get32(state.r[i])) return false;
+        }
+    }
+    if (flags & TRACE_NZCV) {
+        if (!need(1)) return false;
+        state.cpsr = (state.cpsr & ~TRACE_NZCV_MASK) | static_cast<uint32_t>(buf[pos++]) << 28;
+    }
+    if ((flags & TRACE_CPSR) && !get32(state.cpsr)) return false;
+
+    state.index = index++;
+    state.pc = pc;
+    state.r[15] = pc;
+    state.opcode = op;
+    state.changed = mask;
+    state.cpsr_changed = (flags & (TRACE_CPSR | TRACE_NZCV)) != 0;
+    next_pc = pc + 2;
+    rec = state;
+    return true;
+}
+
+}
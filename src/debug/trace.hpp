@@ -0,0 +1,194 @@
+#pragma once
+#include <bit>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+namespace gba {
+
+// Streaming binary execution trace.
+//
+// File layout: a fixed header (magic, version, initial r0-r15 and CPSR) followed
+// by one variable-length record per executed instruction:
+//
+//   u8      flags     TRACE_PC | TRACE_REG | TRACE_CPSR | TRACE_NZCV, and the
+//                     written register in the high nibble
+//   u16     opcode
+//   [u32    pc]       only when it is not previous pc + 2
+//   [u32    value]    TRACE_REG, register r0-r14: its new value
+//   [u16 mask, u32..] TRACE_REG, register 15: several registers, values ascending
+//   [u8     nzcv]     TRACE_NZCV: only the condition flags changed, new CPSR >> 28
+//   [u32    cpsr]     TRACE_CPSR: new value
+//
+// Registers are compared with SIMD; Thumb instructions change at most one, so
+// the several-register form is a rare slow path. Fields are fixed size: every
+// candidate field is stored and the cursor advances past only the present
+// ones, with no data-dependent branches on the emulation thread.
+// Pages are filled on the emulation thread while a background thread writes
+// the other to disk (double buffering); it only blocks when the disk falls a
+// full page behind.
+
+inline constexpr char TRACE_MAGIC[8] = {'G', 'B', 'A', 'T', 'R', 'A', 'C', 'E'};
+inline constexpr uint32_t TRACE_VERSION = 2;
+
+enum : uint8_t {
+    TRACE_PC   = 1u << 0,
+    TRACE_REG  = 1u << 1,
+    TRACE_CPSR = 1u << 2,
+    TRACE_NZCV = 1u << 3,
+};
+inline constexpr uint32_t TRACE_REG_SHIFT = 4;
+inline constexpr uint32_t TRACE_REG_MULTI = 15;
+inline constexpr uint32_t TRACE_NZCV_MASK = 0xF0000000u;
+
+
+// Decoded state after one instruction
+struct TraceRecord {
+    uint64_t index{0};
+    uint32_t pc{0};       // address of the instruction
+    uint16_t opcode{0};
+    uint16_t changed{0};  // register mask written by it
+    bool cpsr_changed{false};
+    uint32_t r[16]{};     // r0-r14 after execution; r[15] = pc
+    uint32_t cpsr{0};
+};
+
+struct TraceWriter {
+    static constexpr size_t PAGE_BYTES = 1u << 20;
+    static constexpr size_t MAX_RECORD = 1 + 2 + 4 + 2 + 15 * 4 + 4;
+
+    TraceWriter() = default;
+    ~TraceWriter() { close(); }
+    TraceWriter(const TraceWriter&) = delete;
+    TraceWriter& operator=(const TraceWriter&) = delete;
+
+    // Starts the writer thread and writes the header with the initial state
+    bool open(const std::string& path, const uint32_t (&regs)[16], uint32_t cpsr);
+    // Flushes the remaining records and joins the writer thread
+    void close();
+    bool is_open() const { return file != nullptr; }
+    uint64_t records() const { return count; }
+    // Only meaningful after close()
+    uint64_t bytes_written() const { return written; }
+    bool write_failed() const { return failed; }
+
+    // Hot path: called by CPU::step with the state after each instruction.
+    // Every register is compared against the last recorded state, so the trace
+    // shows what the CPU did, not what the opcode is meant to do.
+    void record(uint32_t pc, uint16_t opcode, const uint32_t (&regs)[16], uint32_t cpsr) {
+        if (static_cast<size_t>(end - cur) < MAX_RECORD) [[unlikely]] swap_pages();
+        const uint32_t mask = changed_mask(prev, regs);
+        if (mask & (mask - 1)) [[unlikely]] {
+            record_multi(pc, opcode, mask, regs, cpsr);
+            return;
+        }
+        const uint32_t has_pc = pc != next_pc;
+        const uint32_t has_reg = mask != 0;
+        const uint32_t cpsr_diff = cpsr ^ prev_cpsr;
+        const uint32_t has_cpsr = (cpsr_diff & ~TRACE_NZCV_MASK) != 0;
+        const uint32_t has_nzcv = (cpsr_diff != 0) & !has_cpsr;
+        // With no change this stores r15 and skips it again
+        const uint32_t reg = static_cast<uint32_t>(std::countr_zero(mask | 0x8000u));
+        // Local cursor: stores through uint8_t* may alias members
+        uint8_t* p = cur;
+        p[0] = static_cast<uint8_t>(has_pc * TRACE_PC | has_reg * TRACE_REG | has_cpsr * TRACE_CPSR |
+                                    has_nzcv * TRACE_NZCV | (has_reg * reg) << TRACE_REG_SHIFT);
+        std::memcpy(p + 1, &opcode, 2);
+        p += 3;
+        std::memcpy(p, &pc, 4);
+        p += 4 * has_pc;
+        std::memcpy(p, &regs[reg], 4);
+        p += 4 * has_reg;
+        p[0] = static_cast<uint8_t>(cpsr >> 28);
+        p += has_nzcv;
+        std::memcpy(p, &cpsr, 4);
+        p += 4 * has_cpsr;
+        cur = p;
+        // Whole-array copy: a narrow store here would stall the wide loads above
+        std::memcpy(prev, regs, sizeof(prev));
+        prev_cpsr = cpsr;
+        next_pc = pc + 2;
+        ++count;
+    }
+
+private:
+    std::FILE* file{nullptr};
+    std::vector<uint8_t> pages[2];
+    int active{0};
+    uint8_t* cur{nullptr};
+    uint8_t* end{nullptr};
+    uint32_t next_pc{0};
+    uint32_t prev[16]{};   // last recorded r0-r15 (r15 never compared)
+    uint32_t prev_cpsr{0};
+    uint64_t count{0};
+    uint64_t written{0};
+
+    // Hand-off to the writer thread
+    std::thread worker;
+    std::mutex mtx;
+    std::condition_variable cv;
+    const uint8_t* pending{nullptr};
+    size_t pending_size{0};
+    bool stopping{false};
+    bool failed{false};
+
+    // Registers r0-r14 that differ (PC is implied by the next record)
+    static uint32_t changed_mask(const uint32_t (&a)[16], const uint32_t (&b)[16]) {
+#if defined(__SSE2__) || defined(_M_X64)
+        uint32_t same = 0;
+        for (int k = 0; k < 4; ++k) {
+            __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + 4 * k));
+            __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + 4 * k));
+            same |= static_cast<uint32_t>(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(va, vb)))) << (4 * k);
+        }
+        return ~same & 0x7FFF;
+#else
+        uint32_t mask = 0;
+        for (int i = 0; i < 15; ++i) mask |= static_cast<uint32_t>(a[i] != b[i]) << i;
+        return mask;
+#endif
+    }
+
+    // Several registers changed in one step (slow path, out of line)
+    void record_multi(uint32_t pc, uint16_t opcode, uint32_t mask, const uint32_t (&regs)[16], uint32_t cpsr);
+    void swap_pages();
+    void writer_loop();
+};
+
+struct TraceReader {
+    TraceReader() = default;
+    ~TraceReader() { close(); }
+    TraceReader(const TraceReader&) = delete;
+    TraceReader& operator=(const TraceReader&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+    // Decode the next record; `rec` receives the full register state after it.
+    // Returns false at end of trace; error() tells truncation from a clean end.
+    bool next(TraceRecord& rec);
+    bool error() const { return bad; }
+    const TraceRecord& initial() const { return start; }
+
+private:
+    std::FILE* file{nullptr};
+    std::vector<uint8_t> buf;
+    size_t pos{0}, len{0};
+    bool bad{false};
+    uint32_t next_pc{0};
+    uint64_t index{0};
+    TraceRecord start;
+    TraceRecord state;
+
+    bool fill(size_t need);
+};
+
+}
@@ -0,0 +1,125 @@
+#include "capture.hpp"
+#include "../util/hash.hpp"
+#include <array>
+
+namespace gba {
+
+namespace {
+
+// BGR555 -> limited-range BT.601 Y'CbCr, one entry per color
+struct YuvTable {
+    std::array<uint8_t, 32768> y, u, v;
+
+    YuvTable() {
+        for (uint32_t px = 0; px < 32768; ++px) {
+            auto exp = [](uint32_t c) { return static_cast<int>((c << 3) | (c >> 2)); };
+            int r = exp((px >> 10) & 0x1F);
+            int g = exp((px >> 5) & 0x1F);
+            int b = exp(px & 0x1F);
+            y[px] = static_cast<uint8_t>(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+            u[px] = static_cast<uint8_t>(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+            v[px] = static_cast<uint8_t>(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+        }
+    }
+};
+
+const YuvTable& yuv_table() {
+    static const YuvTable table;
+    return table;
+}
+
+}
+
+VideoCapture::Format VideoCapture::format_for(const std::string& path) {
+    auto ends_with = [&](const char* ext) {
+        size_t n = std::strlen(ext);
+        return path.size() >= n && path.compare(path.size() - n, n, ext) == 0;
+    };
+    return ends_with(".y4m") || ends_with(".Y4M") ? Format::Y4M : Format::Raw;
+}
+
+bool VideoCapture::open(const std::string& path, const Options& opts) {
+    close();
+    file = std::fopen(path.c_str(), "wb");
+    if (!file) return false;
+
+    options = opts;
+    if (options.pool_frames < 2) options.pool_frames = 2;
+    if (options.format == Format::Y4M) {
+        yuv_table(); // build the table here, not on the first frame
+        if (std::fprintf(file, "YUV4MPEG2 W%d H%d F%u:1 Ip A1:1 C444\n", PPU::WIDTH, PPU::HEIGHT, options.fps) < 0) {
+            std::fclose(file);
+            file = nullptr;
+            return false;
+        }
+        out.resize(3 * FRAME_PIXELS);
+    }
+
+    slots.clear();
+    for (size_t i = 0; i < options.pool_frames; ++i) slots.push_back(std::make_unique<uint16_t[]>(FRAME_PIXELS));
+    head.store(0);
+    tail.store(0);
+    stopping.store(false);
+    dropped = written = duplicates = 0;
+    failed = have_last = false;
+    worker = std::thread(&VideoCapture::writer_loop, this);
+    return true;
+}
+
+void VideoCapture::close() {
+    if (!file) return;
+    stopping.store(true, std::memory_order_release);
+    wake.fetch_add(1, std::memory_order_release);
+    wake.notify_one();
+    worker.join();
+    if (std::fclose(file) != 0) failed = true;
+    file = nullptr;
+}
+
+void VideoCapture::writer_loop() {
+    for (;;) {
+        // Read `wake` before checking for work so a hand-off in between ends the wait
+        uint32_t seen = wake.load(std::memory_order_acquire);
+        uint64_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire)) {
+            if (stopping.load(std::memory_order_acquire)) break;
+            wake.wait(seen, std::memory_order_acquire);
+            continue;
+        }
+        write_frame(slots[t % slots.size()].get());
+        tail.store(t + 1, std::memory_order_release);
+    }
+}
+
+void VideoCapture::write_frame(const uint16_t* px) {
+    if (options.dedupe) {
+        uint64_t h = hash64(px, FRAME_BYTES);
+        if (have_last && h == last_hash) {
+            ++duplicates;
+            return;
+        }
+        have_last = true;
+        last_hash = h;
+    }
+
+    bool ok;
+    if (options.format == Format::Y4M) {
+        const YuvTable& t = yuv_table();
+        uint8_t* y = out.data();
+        uint8_t* u = y + FRAME_PIXELS;
+        uint8_t* v = u + FRAME_PIXELS;
+        for (size_t i = 0; i < FRAME_PIXELS; ++i) {
+            uint16_t c = px[i] & 0x7FFF;
+            y[i] = t.y[c];
+            u[i] = t.u[c];
+            v[i] = t.v[c];
+        }
+        ok = std::fputs("FRAME\n", file) >= 0 && std::fwrite(out.data(), 1, out.size(), file) == out.size();
+    } else {
+        ok = std::fwrite(px, 1, FRAME_BYTES, file) == FRAME_BYTES; // little-endian hosts
+    }
+    if (!ok) failed = true;
+    ++written;
+}
+
+}
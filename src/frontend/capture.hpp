@@ -0,0 +1,94 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../ppu/ppu.hpp"
+
+namespace gba {
+
+// Raw video capture of emulated frames for the frontends.
+//
+// submit() copies the frame into a slot of a fixed pool and returns; a writer
+// thread converts and writes the slots in order. Slots are handed over through
+// a single-producer/single-consumer ring, so the emulation thread never waits
+// on the writer: when every slot is still queued, the frame is dropped and
+// counted instead. With dedupe on, the writer skips frames identical to the
+// last one written (a halted or idle game costs one frame, not one per vsync).
+struct VideoCapture {
+    static constexpr size_t FRAME_PIXELS = PPU::WIDTH * PPU::HEIGHT;
+    static constexpr size_t FRAME_BYTES = FRAME_PIXELS * sizeof(uint16_t);
+
+    enum class Format : uint8_t {
+        Y4M,  // YUV4MPEG2, 4:4:4 8-bit BT.601; plays in mpv/ffplay, feeds ffmpeg
+        Raw,  // headerless little-endian BGR555 frames, as in VRAM
+    };
+
+    struct Options {
+        Format format = Format::Y4M;
+        size_t pool_frames = 8;
+        bool dedupe = true;
+        uint32_t fps = 60; // Y4M header only
+    };
+
+    // .y4m selects Y4M, anything else raw BGR555
+    static Format format_for(const std::string& path);
+
+    VideoCapture() = default;
+    ~VideoCapture() { close(); }
+    VideoCapture(const VideoCapture&) = delete;
+    VideoCapture& operator=(const VideoCapture&) = delete;
+
+    bool open(const std::string& path, const Options& opts);
+    // Drain queued frames and join the writer thread
+    void close();
+    bool is_open() const { return file != nullptr; }
+
+    // Emulation thread: one FRAME_BYTES copy, never blocks
+    void submit(std::span<const uint16_t> frame) {
+        uint64_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) >= slots.size()) {
+            ++dropped;
+            return;
+        }
+        std::memcpy(slots[h % slots.size()].get(), frame.data(), FRAME_BYTES);
+        head.store(h + 1, std::memory_order_release);
+        wake.fetch_add(1, std::memory_order_release);
+        wake.notify_one();
+    }
+
+    uint64_t frames_submitted() const { return head.load(std::memory_order_relaxed) + dropped; }
+    uint64_t frames_dropped() const { return dropped; }
+    // Only meaningful after close()
+    uint64_t frames_written() const { return written; }
+    uint64_t frames_duplicate() const { return duplicates; }
+    bool write_failed() const { return failed; }
+
+private:
+    std::FILE* file{nullptr};
+    Options options;
+    std::vector<std::unique_ptr<uint16_t[]>> slots;
+    std::atomic<uint64_t> head{0}; // next slot to fill (producer)
+    std::atomic<uint64_t> tail{0}; // next slot to write (writer)
+    std::atomic<uint32_t> wake{0}; // bumped on every hand-off, waited on by the writer
+    std::atomic<bool> stopping{false};
+    uint64_t dropped{0};           // producer only
+
+    // Writer thread state
+    std::thread worker;
+    uint64_t written{0};
+    uint64_t duplicates{0};
+    bool failed{false};
+    bool have_last{false};
+    uint64_t last_hash{0};
+    std::vector<uint8_t> out;      // converted frame
+    void writer_loop();
+    void write_frame(const uint16_t* px);
+};
+
+}
@@ -0,0 +1,199 @@
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <chrono>
+#include "../gba.hpp"
+#include "../util/hash.hpp"
+#include "../util/parse.hpp"
+#include "../debug/trace.hpp"
+#include "capture.hpp"
+
+// Headless runner: executes a ROM for a fixed amount of emulated work with no
+// display or vsync, then reports throughput. Used for perf tracking and, with
+// --expect-hash, as a golden-output regression check under ctest.
+
+static void usage() {
+    std::fprintf(stderr,
+        "Usage: gba_headless <rom> [options]\n"
+        "  --frames N          run N frames (default 60)\n"
+        "  --instructions N    run N instructions instead of whole frames\n"
+        "  --hash none|frame|final\n"
+        "                      print a VRAM hash per frame or once at the end (default none)\n"
+        "  --expect-hash HEX   fail unless the final VRAM hash matches\n"
+        "  --trace PATH        record a binary execution trace (see tracediff)\n"
+        "  --save PATH         back cartridge save memory with PATH (created if missing)\n"
+        "  --save-type T       auto|none|sram|flash64|flash128|eeprom512|eeprom8k (default auto)\n"
+        "  --capture PATH      record every frame (.y4m: YUV4MPEG2, otherwise raw BGR555)\n"
+        "  --capture-all       keep frames identical to the previous one\n");
+}
+
+static uint64_t vram_hash(const gba::GBA& system) {
+    return gba::hash64(system.ppu.vram.data(), system.ppu.vram.size_bytes());
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) { usage(); return 2; }
+
+    std::string romPath = argv[1];
+    uint64_t frames = 60;
+    uint64_t instructions = 0;
+    enum class HashMode { None, Frame, Final } hashMode = HashMode::None;
+    bool expectHash = false;
+    uint64_t expected = 0;
+    std::string tracePath;
+    std::string savePath;
+    bool autoSaveType = true;
+    gba::SaveType saveType = gba::SaveType::None;
+    std::string capturePath;
+    bool captureAll = false;
+
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--frames" && hasValue) {
+            if (!gba::parse_uint(argv[++i], frames)) { usage(); return 2; }
+        } else if (arg == "--instructions" && hasValue) {
+            if (!gba::parse_uint(argv[++i], instructions)) { usage(); return 2; }
+        } else if (arg == "--hash" && hasValue) {
+            std::string mode = argv[++i];
+            if (mode == "none") hashMode = HashMode::None;
+            else if (mode == "frame") hashMode = HashMode::Frame;
+            else if (mode == "final") hashMode = HashMode::Final;
+            else { usage(); return 2; }
+        } else if (arg == "--expect-hash" && hasValue) {
+            if (!gba::parse_uint(argv[++i], expected, 16)) { usage(); return 2; }
+            expectHash = true;
+        } else if (arg == "--trace" && hasValue) {
+            tracePath = argv[++i];
+        } else if (arg == "--save" && hasValue) {
+            savePath = argv[++i];
+        } else if (arg == "--capture" && hasValue) {
+            capturePath = argv[++i];
+        } else if (arg == "--capture-all") {
+            captureAll = true;
+        } else if (arg == "--save-type" && hasValue) {
+            std::string type = argv[++i];
+            autoSaveType = type == "auto";
+            if (!autoSaveType && !gba::SaveMemory::parse(type, saveType)) { usage(); return 2; }
+        } else {
+            usage();
+            return 2;
+        }
+    }
+
+    gba::GBA system;
+    system.reset();
+    if (!system.load(romPath)) {
+        std::fprintf(stderr, "Failed to load ROM: %s\n", romPath.c_str());
+        return 1;
+    }
+
+    if (!savePath.empty()) {
+        bool ok = autoSaveType ? system.open_save(savePath) : system.open_save(savePath, saveType);
+        if (!ok) {
+            std::fprintf(stderr, "Failed to open save: %s\n", savePath.c_str());
+            return 1;
+        }
+    }
+
+    gba::TraceWriter trace;
+    if (!tracePath.empty()) {
+        if (!trace.open(tracePath, system.cpu.r, system.cpu.cpsr)) {
+            std::fprintf(stderr, "Failed to open trace: %s\n", tracePath.c_str());
+            return 1;
+        }
+        system.cpu.attach_trace(&trace);
+    }
+
+    gba::VideoCapture capture;
+    if (!capturePath.empty()) {
+        gba::VideoCapture::Options opts;
+        opts.format = gba::VideoCapture::format_for(capturePath);
+        opts.dedupe = !captureAll;
+        if (!capture.open(capturePath, opts)) {
+            std::fprintf(stderr, "Failed to open capture: %s\n", capturePath.c_str());
+            return 1;
+        }
+    }
+
+    const uint64_t total = instructions ? instructions : frames * gba::GBA::STEPS_PER_FRAME;
+    uint64_t executed = 0;
+    uint64_t framesRun = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    while (executed < total) {
+        uint64_t chunk = total - executed;
+        if (chunk > gba::GBA::STEPS_PER_FRAME) chunk = gba::GBA::STEPS_PER_FRAME;
+        for (uint64_t i = 0; i < chunk; ++i) {
+            system.cpu.step();
+        }
+        executed += chunk;
+        if (chunk == gba::GBA::STEPS_PER_FRAME) {
+            ++framesRun;
+            if (capture.is_open()) capture.submit(system.ppu.vram);
+            if (hashMode == HashMode::Frame) {
+                std::printf("frame %llu hash %016llx\n",
+                    static_cast<unsigned long long>(framesRun),
+                    static_cast<unsigned long long>(vram_hash(system)));
+            }
+        }
+    }
+    if (trace.is_open()) {
+        system.cpu.attach_trace(nullptr);
+        trace.close(); // drain the writer thread inside the timed region
+    }
+    capture.close();
+    auto end = std::chrono::steady_clock::now();
+
+    double seconds = std::chrono::duration<double>(end - start).count();
+    double mips = seconds > 0 ? static_cast<double>(executed) / seconds / 1e6 : 0.0;
+    double fps = seconds > 0 ? static_cast<double>(framesRun) / seconds : 0.0;
+    uint64_t finalHash = vram_hash(system);
+
+    std::printf("rom          %s (%zu bytes)\n", romPath.c_str(), system.cart.rom.size());
+    std::printf("instructions %llu\n", static_cast<unsigned long long>(executed));
+    std::printf("frames       %llu\n", static_cast<unsigned long long>(framesRun));
+    std::printf("wall_time_s  %.6f\n", seconds);
+    std::printf("mips         %.3f\n", mips);
+    std::printf("fps          %.2f\n", fps);
+    if (!tracePath.empty()) {
+        std::printf("trace        %s (%llu records, %llu bytes)\n", tracePath.c_str(),
+            static_cast<unsigned long long>(trace.records()),
+            static_cast<unsigned long long>(trace.bytes_written()));
+        if (trace.write_failed()) {
+            std::fprintf(stderr, "Trace write failed: %s\n", tracePath.c_str());
+            return 1;
+        }
+    }
+    if (!capturePath.empty()) {
+        std::printf("capture      %s (%llu written, %llu duplicate, %llu dropped)\n", capturePath.c_str(),
+            static_cast<unsigned long long>(capture.frames_written()),
+            static_cast<unsigned long long>(capture.frames_duplicate()),
+            static_cast<unsigned long long>(capture.frames_dropped()));
+        if (capture.write_failed()) {
+            std::fprintf(stderr, "Capture write failed: %s\n", capturePath.c_str());
+            return 1;
+        }
+    }
+    if (!savePath.empty()) {
+        bool flushed = system.cart.save.flush();
+        std::printf("save         %s (%s, %llu flushes)\n", savePath.c_str(),
+            gba::SaveMemory::name(system.cart.save.type()),
+            static_cast<unsigned long long>(system.cart.save.flushes()));
+        if (!flushed) {
+            std::fprintf(stderr, "Save write failed: %s\n", savePath.c_str());
+            return 1;
+        }
+    }
+    if (hashMode != HashMode::None || expectHash) {
+        std::printf("final_hash   %016llx\n", static_cast<unsigned long long>(finalHash));
+    }
+
+    if (expectHash && finalHash != expected) {
+        std::fprintf(stderr, "VRAM hash mismatch: expected %016llx, got %016llx\n",
+            static_cast<unsigned long long>(expected),
+            static_cast<unsigned long long>(finalHash));
+        return 1;
+    }
+    return 0;
+}
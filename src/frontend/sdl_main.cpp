@@ -1,27 +1,59 @@
 #include <SDL.h>
 #include <cstdint>
+#include <cstdio>
 #include <vector>
 #include <string>
 #include <chrono>
 #include <cmath>
+#include <filesystem>
 #include "../gba.hpp"
+#include "capture.hpp"
 
 static constexpr int GBA_WIDTH = 240;
 static constexpr int GBA_HEIGHT = 160;
 
-int main(int argc, char* argv[]) {
-    gba::GBA system;
-    system.reset();
+static void usage() {
+    std::fprintf(stderr,
+        "Usage: gba_sdl [rom] [options]\n"
+        "  --capture PATH      record every frame (.y4m: YUV4MPEG2, otherwise raw BGR555)\n"
+        "  --capture-all       keep frames identical to the previous one\n");
+}
 
+int main(int argc, char* argv[]) {
     bool hasRom = false;
     std::string romPath;
-    if (argc >= 2) {
-        romPath = argv[1];
+    std::string capturePath;
+    bool captureAll = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--capture" && hasValue) {
+            capturePath = argv[++i];
+        } else if (arg == "--capture-all") {
+            captureAll = true;
+        } else if (arg.empty() || arg[0] == '-' || !romPath.empty()) {
+            usage();
+            return 2;
+        } else {
+            romPath = arg;
+        }
+    }
+
+    gba::GBA system;
+    system.reset();
+    if (!romPath.empty()) {
         if (!system.load(romPath)) {
             SDL_Log("Failed to load ROM: %s", romPath.c_str());
         } else {
             SDL_Log("Loaded ROM: %s (%zu bytes)", romPath.c_str(), system.cart.rom.size());
             hasRom = true;
+            // Battery save next to the ROM; flushed in the background and at exit
+            std::string savePath = std::filesystem::path(romPath).replace_extension(".sav").string();
+            if (!system.open_save(savePath)) {
+                SDL_Log("Failed to open save: %s", savePath.c_str());
+            } else if (system.cart.save.type() != gba::SaveType::None) {
+                SDL_Log("Save: %s (%s)", savePath.c_str(), gba::SaveMemory::name(system.cart.save.type()));
+            }
         }
     }
 
@@ -57,6 +89,15 @@ int main(int argc, char* argv[]) {
         return 1;
     }
 
+    gba::VideoCapture capture;
+    if (!capturePath.empty()) {
+        gba::VideoCapture::Options opts;
+        opts.format = gba::VideoCapture::format_for(capturePath);
+        opts.dedupe = !captureAll;
+        if (capture.open(capturePath, opts)) SDL_Log("Capturing to %s", capturePath.c_str());
+        else SDL_Log("Failed to open capture: %s", capturePath.c_str());
+    }
+
     std::vector<uint32_t> argb;
 
     bool running = true;
@@ -74,9 +115,7 @@ int main(int argc, char* argv[]) {
 
         if (hasRom) {
             // Step CPU a bunch of instructions per frame
-            // Tune this number as needed; we just want visible progress for tiny test ROMs
-            constexpr int STEPS_PER_FRAME = 200000; // 200k thumb ops
-            for (int i = 0; i < STEPS_PER_FRAME; ++i) {
+            for (int i = 0; i < gba::GBA::STEPS_PER_FRAME; ++i) {
                 system.cpu.step();
             }
         } else {
@@ -93,6 +132,7 @@ int main(int argc, char* argv[]) {
             }
         }
 
+        if (capture.is_open()) capture.submit(system.ppu.vram);
         system.render_mode3_to_argb(argb);
         SDL_UpdateTexture(texture, nullptr, argb.data(), GBA_WIDTH * sizeof(uint32_t));
 
@@ -113,6 +153,15 @@ int main(int argc, char* argv[]) {
         SDL_RenderPresent(renderer);
     }
 
+    if (capture.is_open()) {
+        capture.close();
+        SDL_Log("Capture: %llu frames written, %llu duplicate, %llu dropped%s",
+            static_cast<unsigned long long>(capture.frames_written()),
+            static_cast<unsigned long long>(capture.frames_duplicate()),
+            static_cast<unsigned long long>(capture.frames_dropped()),
+            capture.write_failed() ? " (write failed)" : "");
+    }
+
     SDL_DestroyTexture(texture);
     SDL_DestroyRenderer(renderer);
     SDL_DestroyWindow(window);
@@ -1,5 +1,27 @@
 #include "gba.hpp"
+#include <algorithm>
 
 namespace gba {
 
+GBA::GBA(const Snapshot& snap) : arena(snap.memory), cpu(snap.cpu) {
+    cpu.attach_trace(nullptr); // a trace follows one machine, not its clones
+    cart.save.attach(snap.save_type, arena.save());
+    cart.save.restore(snap.save_protocol);
+    bind_memory();
+}
+
+GBA::Snapshot GBA::snapshot() {
+    // Anonymous saves already live in the arena
+    if (cart.save.is_file_backed()) {
+        auto save = cart.save.bytes();
+        std::copy(save.begin(), save.end(), arena.save().begin());
+    }
+    // freeze() remaps the arena in place, so our own views stay valid
+    return Snapshot{arena.freeze(), cpu, cart.save.type(), cart.save.protocol()};
+}
+
+std::unique_ptr<GBA> GBA::Snapshot::spawn() const {
+    return std::make_unique<GBA>(*this);
+}
+
 }
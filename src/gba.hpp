@@ -3,22 +3,72 @@
 #include "bus/bus.hpp"
 #include "cart/rom.hpp"
 #include "ppu/ppu.hpp"
+#include "mem/arena.hpp"
+#include <memory>
 #include <vector>
 
 namespace gba {
 
 struct GBA {
+    // Thumb instructions executed per displayed frame by the frontends. Tuned for
+    // visible progress on tiny test ROMs, not cycle accuracy.
+    static constexpr int STEPS_PER_FRAME = 200000;
+
+    // Declared first: every other component views memory owned by the arena
+    MemoryArena arena;
     CPU cpu;
     Bus bus;
     Cartridge cart;
     PPU ppu;
 
+    // Frozen machine state; spawn() any number of copy-on-write instances from it
+    struct Snapshot {
+        std::shared_ptr<const ArenaImage> memory;
+        CPU cpu;
+        SaveType save_type{SaveType::None}; // contents are in `memory`
+        SaveMemory::Protocol save_protocol;
+
+        std::unique_ptr<GBA> spawn() const;
+    };
+
+    explicit GBA(MemoryArena::Options opts = {}) : arena(opts) { bind_memory(); }
+    explicit GBA(const Snapshot& snap);
+
+    // Components hold pointers into each other and the arena
+    GBA(const GBA&) = delete;
+    GBA& operator=(const GBA&) = delete;
+
     void reset() {
         cpu.reset();
-        bus.connect(&ppu, &cart);
-        cpu.attach_bus(&bus);
+        bind_memory();
+    }
+    bool load(const std::string& romPath) {
+        bool ok = cart.load_from_file(romPath, arena);
+        bind_memory(); // the fallback arena may have moved while growing
+        return ok;
     }
-    bool load(const std::string& romPath) { return cart.load_from_file(romPath); }
+    bool load(std::span<const uint8_t> romBytes) {
+        bool ok = cart.load_from_bytes(romBytes, arena);
+        bind_memory();
+        return ok;
+    }
+
+    // Back the cartridge's save memory with `path` (created if missing). The
+    // type is detected from the loaded ROM unless given; a ROM with no save
+    // memory leaves it closed and succeeds.
+    bool open_save(const std::string& path) { return cart.save.open(path, SaveMemory::detect(cart.rom)); }
+    bool open_save(const std::string& path, SaveType type) { return cart.save.open(path, type); }
+    // Erased save memory with no file, kept in the arena (benchmarks, tests)
+    void open_anonymous_save(SaveType type) { cart.save.open_anonymous(type, arena.save()); }
+
+    // Freeze the running machine. Cheap: memory is shared copy-on-write and
+    // only copied once when this instance has diverged from its last image. A
+    // file-backed save is copied into the arena; spawned machines never write
+    // the file.
+    Snapshot snapshot();
+    // Fork this machine; to branch many times from one state, prefer a single
+    // snapshot() followed by repeated Snapshot::spawn().
+    std::unique_ptr<GBA> clone() { return snapshot().spawn(); }
 
     void render_mode3_to_argb(std::vector<uint32_t>& out) {
         out.resize(PPU::WIDTH * PPU::HEIGHT);
@@ -26,6 +76,15 @@ struct GBA {
             out[i] = PPU::bgr555_to_argb8888(ppu.vram[i]);
         }
     }
+
+private:
+    void bind_memory() {
+        ppu.vram = arena.vram();
+        cart.rom = arena.rom();
+        cart.save.rebind(arena.save());
+        bus.connect(&ppu, &cart, arena.wram());
+        cpu.attach_bus(&bus);
+    }
 };
 
 }
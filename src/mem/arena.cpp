@@ -0,0 +1,237 @@
+#include "arena.hpp"
+#include <cstring>
+#include <new>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <unistd.h>
+#include <fcntl.h>
+#endif
+
+namespace gba {
+
+MemoryArena::MemoryArena() : MemoryArena(Options{}) {}
+
+#if defined(__linux__)
+
+struct ArenaFd {
+    int fd{-1};
+    explicit ArenaFd(int f) : fd(f) {}
+    ~ArenaFd() { if (fd >= 0) ::close(fd); }
+};
+
+struct ArenaImage {
+    std::shared_ptr<ArenaFd> ram;
+    std::shared_ptr<ArenaFd> rom;
+    size_t rom_size{0};
+    bool huge{false};
+    bool want_huge{false}; // Options::huge_pages of the arena it came from
+};
+
+static constexpr size_t RESERVE_BYTES = MemoryArena::ROM_OFFSET + MemoryArena::ROM_CAPACITY;
+
+static size_t page_round(size_t n) {
+    size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    return (n + page - 1) & ~(page - 1);
+}
+
+static std::shared_ptr<ArenaFd> try_memfd(const char* name, size_t size, unsigned flags) {
+    int fd = ::memfd_create(name, MFD_CLOEXEC | flags);
+    if (fd < 0) return nullptr;
+    auto handle = std::make_shared<ArenaFd>(fd);
+    if (::ftruncate(fd, static_cast<off_t>(size)) != 0) return nullptr;
+    return handle;
+}
+
+// Create a sized memfd; with want_huge, hugetlbfs is tried first and `huge`
+// reports whether it was obtained.
+static std::shared_ptr<ArenaFd> make_memfd(const char* name, size_t size, bool want_huge, bool& huge) {
+    huge = false;
+#ifdef MFD_HUGETLB
+    if (want_huge) {
+        if (auto fd = try_memfd(name, size, MFD_HUGETLB)) {
+            // Shared hugetlbfs mappings reserve their pages per file at mmap
+            // time; probe once so a pool shortage falls back here. Private
+            // (copy-on-write) mappings reserve again per mapping; map_ram()
+            // handles their shortage.
+            void* probe = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd->fd, 0);
+            if (probe != MAP_FAILED) {
+                ::munmap(probe, size);
+                huge = true;
+                return fd;
+            }
+        }
+    }
+#endif
+    auto fd = try_memfd(name, size, 0);
+    if (!fd) throw std::bad_alloc();
+    return fd;
+}
+
+void MemoryArena::reserve() {
+    // Over-reserve so the base can be aligned for huge pages, then trim
+    size_t len = RESERVE_BYTES + SEGMENT_ALIGN;
+    void* p = ::mmap(nullptr, len, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (p == MAP_FAILED) throw std::bad_alloc();
+    uintptr_t raw = reinterpret_cast<uintptr_t>(p);
+    uintptr_t aligned = (raw + SEGMENT_ALIGN - 1) & ~(uintptr_t)(SEGMENT_ALIGN - 1);
+    if (aligned > raw) ::munmap(p, aligned - raw);
+    size_t tail = (raw + len) - (aligned + RESERVE_BYTES);
+    if (tail) ::munmap(reinterpret_cast<void*>(aligned + RESERVE_BYTES), tail);
+    mem = reinterpret_cast<uint8_t*>(aligned);
+}
+
+// Ordinary memfd holding a copy of `fd`'s RAM_BYTES
+static std::shared_ptr<ArenaFd> plain_copy(int fd) {
+    bool unused;
+    auto copy = make_memfd("gba-ram", MemoryArena::RAM_BYTES, false, unused);
+    void* src = ::mmap(nullptr, MemoryArena::RAM_BYTES, PROT_READ, MAP_SHARED, fd, 0);
+    if (src == MAP_FAILED) throw std::bad_alloc();
+    void* dst = ::mmap(nullptr, MemoryArena::RAM_BYTES, PROT_READ | PROT_WRITE, MAP_SHARED, copy->fd, 0);
+    if (dst == MAP_FAILED) { ::munmap(src, MemoryArena::RAM_BYTES); throw std::bad_alloc(); }
+    std::memcpy(dst, src, MemoryArena::RAM_USED);
+    ::munmap(dst, MemoryArena::RAM_BYTES);
+    ::munmap(src, MemoryArena::RAM_BYTES);
+    return copy;
+}
+
+void MemoryArena::map_ram(int fd, bool shared) {
+    int flags = MAP_FIXED | (shared ? MAP_SHARED : MAP_PRIVATE);
+    if (::mmap(mem, RAM_BYTES, PROT_READ | PROT_WRITE, flags, fd, 0) == MAP_FAILED) {
+        // Each private hugetlbfs mapping reserves its own huge pages; when the
+        // pool runs dry, continue copy-on-write over an ordinary copy instead.
+        // The contents are always in the file: callers only map ram_fd.
+        if (shared || !huge) throw std::bad_alloc();
+        ram_fd = plain_copy(fd);
+        huge = false;
+        if (::mmap(mem, RAM_BYTES, PROT_READ | PROT_WRITE, flags, ram_fd->fd, 0) == MAP_FAILED) throw std::bad_alloc();
+    }
+#ifdef MADV_HUGEPAGE
+    // Transparent huge pages are only the fallback for a requested hugetlbfs
+    if (want_huge && !huge) ::madvise(mem, RAM_BYTES, MADV_HUGEPAGE);
+#endif
+    ram_shared = shared;
+}
+
+void MemoryArena::map_rom(int fd, size_t size, bool writable) {
+    uint8_t* at = mem + ROM_OFFSET;
+    if (rom_mapped) {
+        // Return the old window to the PROT_NONE reservation
+        ::mmap(at, rom_mapped, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_FIXED, -1, 0);
+        rom_mapped = 0;
+    }
+    rom_size = size;
+    if (fd < 0 || size == 0) return;
+    size_t len = page_round(size);
+    int prot = PROT_READ | (writable ? PROT_WRITE : 0);
+    if (::mmap(at, len, prot, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED) throw std::bad_alloc();
+    rom_mapped = len;
+}
+
+MemoryArena::MemoryArena(Options opts) {
+    reserve();
+    want_huge = opts.huge_pages;
+    try {
+        ram_fd = make_memfd("gba-ram", RAM_BYTES, opts.huge_pages, huge);
+        map_ram(ram_fd->fd, true);
+    } catch (...) {
+        ::munmap(mem, RESERVE_BYTES);
+        throw;
+    }
+}
+
+MemoryArena::MemoryArena(std::shared_ptr<const ArenaImage> image) {
+    reserve();
+    try {
+        ram_fd = image->ram;
+        rom_fd = image->rom;
+        huge = image->huge;
+        want_huge = image->want_huge;
+        map_ram(ram_fd->fd, false);
+        map_rom(rom_fd ? rom_fd->fd : -1, image->rom_size, false);
+    } catch (...) {
+        ::munmap(mem, RESERVE_BYTES);
+        throw;
+    }
+}
+
+MemoryArena::~MemoryArena() {
+    if (mem) ::munmap(mem, RESERVE_BYTES);
+}
+
+std::span<uint8_t> MemoryArena::alloc_rom(size_t size) {
+    if (size > ROM_CAPACITY) size = ROM_CAPACITY;
+    bool unused;
+    rom_fd = size ? make_memfd("gba-rom", page_round(size), false, unused) : nullptr;
+    map_rom(rom_fd ? rom_fd->fd : -1, size, true);
+    return {mem + ROM_OFFSET, size};
+}
+
+void MemoryArena::seal_rom() {
+    if (rom_mapped) ::mprotect(mem + ROM_OFFSET, rom_mapped, PROT_READ);
+}
+
+std::shared_ptr<const ArenaImage> MemoryArena::freeze() {
+    auto image = std::make_shared<ArenaImage>();
+    if (!ram_shared) {
+        // Private pages over an older image: materialise the current view once
+        auto fresh = make_memfd("gba-ram", RAM_BYTES, huge, huge);
+        void* tmp = ::mmap(nullptr, RAM_BYTES, PROT_READ | PROT_WRITE, MAP_SHARED, fresh->fd, 0);
+        if (tmp == MAP_FAILED) throw std::bad_alloc();
+        std::memcpy(tmp, mem, RAM_USED);
+        ::munmap(tmp, RAM_BYTES);
+        ram_fd = std::move(fresh);
+    }
+    // The file now holds exactly our contents; nobody writes it from here on
+    map_ram(ram_fd->fd, false);
+    image->ram = ram_fd;
+    image->rom = rom_fd;
+    image->rom_size = rom_size;
+    image->huge = huge;
+    image->want_huge = want_huge;
+    return image;
+}
+
+bool MemoryArena::supports_cow() { return true; }
+
+#else // portable fallback: one heap block, clones copy
+
+struct ArenaFd {};
+
+struct ArenaImage {
+    std::vector<uint8_t> bytes;
+};
+
+MemoryArena::MemoryArena(Options) : heap(RAM_BYTES) {
+    mem = heap.data();
+}
+
+MemoryArena::MemoryArena(std::shared_ptr<const ArenaImage> image) : heap(image->bytes) {
+    mem = heap.data();
+    rom_size = heap.size() - ROM_OFFSET;
+}
+
+MemoryArena::~MemoryArena() = default;
+
+std::span<uint8_t> MemoryArena::alloc_rom(size_t size) {
+    if (size > ROM_CAPACITY) size = ROM_CAPACITY;
+    heap.resize(ROM_OFFSET);
+    heap.resize(ROM_OFFSET + size);
+    mem = heap.data();
+    rom_size = size;
+    return {mem + ROM_OFFSET, size};
+}
+
+void MemoryArena::seal_rom() {}
+
+std::shared_ptr<const ArenaImage> MemoryArena::freeze() {
+    auto image = std::make_shared<ArenaImage>();
+    image->bytes = heap;
+    return image;
+}
+
+bool MemoryArena::supports_cow() { return false; }
+
+#endif
+
+}
@@ -0,0 +1,102 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <vector>
+#include "../bus/bus.hpp"
+#include "../cart/save.hpp"
+#include "../ppu/ppu.hpp"
+
+namespace gba {
+
+struct ArenaImage; // fwd: frozen, shareable arena contents (see freeze())
+struct ArenaFd;    // fwd: owning memfd handle
+
+// All emulated memory of one GBA instance lives in a single contiguous block:
+//
+//   base + WRAM_OFFSET : on-board work RAM
+//   base + VRAM_OFFSET : Mode 3 frame buffer
+//   base + SAVE_OFFSET : cartridge save memory not backed by a file
+//   base + ROM_OFFSET  : cartridge ROM (read-only once loaded)
+//
+// On Linux the RAM part is a memfd mapping, so an instance can be frozen into an
+// image and any number of clones mapped copy-on-write on top of it. The ROM is a
+// separate memfd shared read-only by every clone and is never copied.
+// Other platforms fall back to a plain heap block and clone by copying.
+struct MemoryArena {
+    // Huge-page sized segments keep the RAM part eligible for a single 2MB page
+    static constexpr size_t SEGMENT_ALIGN = 2 * 1024 * 1024;
+
+    static constexpr size_t WRAM_OFFSET = 0;
+    static constexpr size_t WRAM_BYTES  = Bus::WRAM_SIZE;
+    static constexpr size_t VRAM_OFFSET = WRAM_OFFSET + WRAM_BYTES;
+    static constexpr size_t VRAM_BYTES  = PPU::WIDTH * PPU::HEIGHT * sizeof(uint16_t);
+    static constexpr size_t SAVE_OFFSET = (VRAM_OFFSET + VRAM_BYTES + 4095) & ~size_t{4095};
+    static constexpr size_t SAVE_BYTES  = SaveMemory::MAX_BYTES;
+    static constexpr size_t RAM_USED    = SAVE_OFFSET + SAVE_BYTES;
+    static constexpr size_t RAM_BYTES   = (RAM_USED + SEGMENT_ALIGN - 1) & ~(SEGMENT_ALIGN - 1);
+    static constexpr size_t ROM_OFFSET  = RAM_BYTES;
+    static constexpr size_t ROM_CAPACITY = Bus::ROM_SIZE;
+
+    struct Options {
+        // Try hugetlbfs, then transparent huge pages. Every copy-on-write
+        // mapping (freeze() and each clone) reserves its own huge pages; when
+        // the pool is exhausted it continues on an ordinary copy of the RAM.
+        // Off, arenas and their clones use ordinary pages with no THP advice.
+        bool huge_pages = false;
+    };
+
+    MemoryArena();
+    explicit MemoryArena(Options opts);
+    // Map a frozen image copy-on-write (or copy it, on the fallback path)
+    explicit MemoryArena(std::shared_ptr<const ArenaImage> image);
+    ~MemoryArena();
+
+    MemoryArena(const MemoryArena&) = delete;
+    MemoryArena& operator=(const MemoryArena&) = delete;
+
+    std::span<uint8_t>  wram() { return {base() + WRAM_OFFSET, WRAM_BYTES}; }
+    std::span<uint16_t> vram() { return {reinterpret_cast<uint16_t*>(base() + VRAM_OFFSET), VRAM_BYTES / 2}; }
+    std::span<uint8_t>  save() { return {base() + SAVE_OFFSET, SAVE_BYTES}; }
+    std::span<const uint8_t> rom() const { return {base() + ROM_OFFSET, rom_size}; }
+
+    uint8_t* base() { return mem; }
+    const uint8_t* base() const { return mem; }
+
+    // Replace the ROM with `size` zeroed bytes and return them for loading.
+    // The span is only valid until the next call; rebind views afterwards
+    // (the fallback path may move the whole arena).
+    std::span<uint8_t> alloc_rom(size_t size);
+    // Make the ROM read-only after loading (no-op on the fallback path)
+    void seal_rom();
+
+    // Freeze the current contents into an immutable image and continue on top of
+    // it copy-on-write. The first freeze of a fresh arena is free; later ones copy
+    // the RAM_USED bytes once. The ROM is shared, never copied.
+    std::shared_ptr<const ArenaImage> freeze();
+
+    // True when clones share pages copy-on-write instead of copying
+    static bool supports_cow();
+
+private:
+    uint8_t* mem{nullptr};
+    size_t rom_size{0};
+    size_t rom_mapped{0};
+
+#if defined(__linux__)
+    std::shared_ptr<ArenaFd> ram_fd;
+    std::shared_ptr<ArenaFd> rom_fd;
+    bool ram_shared{false};             // RAM mapped MAP_SHARED (fresh) vs. private over an image
+    bool huge{false};
+    bool want_huge{false};              // Options::huge_pages, inherited by clones
+
+    void reserve();
+    void map_ram(int fd, bool shared);
+    void map_rom(int fd, size_t size, bool writable);
+#else
+    std::vector<uint8_t> heap;
+#endif
+};
+
+}
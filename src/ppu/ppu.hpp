@@ -1,6 +1,6 @@
 #pragma once
 #include <cstdint>
-#include <array>
+#include <span>
 
 namespace gba {
 
@@ -9,8 +9,9 @@ struct PPU {
     static constexpr int WIDTH = 240;
     static constexpr int HEIGHT = 160;
 
-    // Simulated VRAM Mode 3 (each pixel 16-bit BGR555)
-    std::array<uint16_t, WIDTH * HEIGHT> vram{};
+    // Simulated VRAM Mode 3 (each pixel 16-bit BGR555); WIDTH * HEIGHT pixels
+    // viewed from the GBA's MemoryArena
+    std::span<uint16_t> vram;
 
     // Convert BGR555 to ARGB8888 for the SDL front-end
     static inline uint32_t bgr555_to_argb8888(uint16_t px) {
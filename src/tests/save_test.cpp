@@ -0,0 +1,183 @@
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "../cart/save.hpp"
+
+// Checks for the SaveMemory protocols: EEPROM serial reads and writes for both
+// chip sizes, Flash identification and erase, and Eeprom512 detection from the
+// size of an existing file (written into the given directory).
+// Run by ctest; exits non-zero on the first failure.
+
+namespace {
+
+int failures = 0;
+
+void check(bool ok, const char* what) {
+    if (!ok) {
+        std::fprintf(stderr, "FAIL: %s\n", what);
+        ++failures;
+    }
+}
+
+// --- EEPROM: one bit per access, MSB first -----------------------------------
+
+void send_bits(gba::SaveMemory& save, uint64_t value, int bits) {
+    for (int i = bits - 1; i >= 0; --i) save.eeprom_write(static_cast<uint16_t>((value >> i) & 1));
+}
+
+void eeprom_write_block(gba::SaveMemory& save, uint32_t block, int addr_bits, uint64_t value) {
+    send_bits(save, 0b10, 2);
+    send_bits(save, block, addr_bits);
+    send_bits(save, value, 64);
+    send_bits(save, 0, 1);
+}
+
+// Returns the 64-bit block; `junk_ok` reports whether the 4 leading bits were 0
+uint64_t eeprom_read_block(gba::SaveMemory& save, uint32_t block, int addr_bits, bool& junk_ok) {
+    send_bits(save, 0b11, 2);
+    send_bits(save, block, addr_bits);
+    send_bits(save, 0, 1);
+    junk_ok = true;
+    for (int i = 0; i < 4; ++i) junk_ok = junk_ok && save.eeprom_read() == 0;
+    uint64_t value = 0;
+    for (int i = 0; i < 64; ++i) value = (value << 1) | save.eeprom_read();
+    return value;
+}
+
+void eeprom_8k() {
+    std::vector<uint8_t> storage(gba::SaveMemory::MAX_BYTES);
+    gba::SaveMemory save;
+    save.open_anonymous(gba::SaveType::Eeprom8K, storage);
+    eeprom_write_block(save, 0x3FF, 14, 0x0123456789ABCDEFull);
+    eeprom_write_block(save, 0x001, 14, 0xFEDCBA9876543210ull);
+    check(save.bytes()[0x3FF * 8] == 0x01 && save.bytes()[0x3FF * 8 + 7] == 0xEF, "EEPROM 8K stores MSB first");
+    check(save.eeprom_read() == 1, "EEPROM ready outside a read");
+
+    bool junk_ok = false;
+    check(eeprom_read_block(save, 0x3FF, 14, junk_ok) == 0x0123456789ABCDEFull, "EEPROM 8K read back");
+    check(junk_ok, "EEPROM read starts with 4 zero bits");
+    check(save.eeprom_read() == 1, "EEPROM ready after 68 read bits");
+    check(eeprom_read_block(save, 0x001, 14, junk_ok) == 0xFEDCBA9876543210ull, "EEPROM 8K second block");
+    check(eeprom_read_block(save, 0x002, 14, junk_ok) == ~0ull, "EEPROM 8K untouched block erased");
+}
+
+void eeprom_512() {
+    std::vector<uint8_t> storage(gba::SaveMemory::MAX_BYTES);
+    gba::SaveMemory save;
+    save.open_anonymous(gba::SaveType::Eeprom512, storage);
+    // Six address bits: the 64-bit data follows right after them
+    eeprom_write_block(save, 0x3F, 6, 0x1122334455667788ull);
+    check(save.bytes()[504] == 0x11 && save.bytes()[511] == 0x88, "EEPROM 512 stores the last block");
+    bool junk_ok = false;
+    check(eeprom_read_block(save, 0x3F, 6, junk_ok) == 0x1122334455667788ull, "EEPROM 512 read back");
+    check(junk_ok, "EEPROM 512 read junk bits");
+}
+
+void eeprom_512_from_file(const std::string& dir) {
+    std::string path = dir + "/save_test_eeprom512.sav";
+    std::vector<uint8_t> contents(512, 0xFF);
+    for (int i = 0; i < 8; ++i) contents[8 + i] = static_cast<uint8_t>(0xA0 + i);
+    std::FILE* f = std::fopen(path.c_str(), "wb");
+    check(f && std::fwrite(contents.data(), 1, contents.size(), f) == contents.size(), "write 512-byte save");
+    if (f) std::fclose(f);
+
+    gba::SaveMemory save;
+    check(save.open(path, gba::SaveType::Eeprom8K), "open 512-byte save");
+    check(save.type() == gba::SaveType::Eeprom512, "512-byte file selects Eeprom512");
+    check(save.bytes().size() == 512, "Eeprom512 size");
+    bool junk_ok = false;
+    check(eeprom_read_block(save, 1, 6, junk_ok) == 0xA0A1A2A3A4A5A6A7ull, "Eeprom512 reads file contents");
+    save.close();
+    std::remove(path.c_str());
+}
+
+// --- Flash -------------------------------------------------------------------
+
+void flash_command(gba::SaveMemory& save, uint8_t cmd, uint32_t off = 0x5555) {
+    save.write8(0x5555, 0xAA);
+    save.write8(0x2AAA, 0x55);
+    save.write8(off, cmd);
+}
+
+void flash_program(gba::SaveMemory& save, uint32_t off, uint8_t v) {
+    flash_command(save, 0xA0);
+    save.write8(off, v);
+}
+
+void flash_bank(gba::SaveMemory& save, uint8_t bank) {
+    flash_command(save, 0xB0);
+    save.write8(0, bank);
+}
+
+void flash_id() {
+    std::vector<uint8_t> storage(gba::SaveMemory::MAX_BYTES);
+    gba::SaveMemory save;
+    save.open_anonymous(gba::SaveType::Flash64K, storage);
+    flash_program(save, 0, 0x5A);
+    flash_command(save, 0x90);
+    check(save.read8(0) == 0x32 && save.read8(1) == 0x1B, "Flash64K ID bytes");
+    flash_command(save, 0xF0);
+    check(save.read8(0) == 0x5A, "Flash64K leaves ID mode");
+
+    save.open_anonymous(gba::SaveType::Flash128K, storage);
+    flash_command(save, 0x90);
+    check(save.read8(0) == 0x62 && save.read8(1) == 0x13, "Flash128K ID bytes");
+    save.write8(0, 0xF0); // unprefixed reset
+    check(save.read8(0) == 0xFF, "Flash128K unprefixed ID reset");
+}
+
+void flash_erase() {
+    std::vector<uint8_t> storage(gba::SaveMemory::MAX_BYTES);
+    gba::SaveMemory save;
+    save.open_anonymous(gba::SaveType::Flash128K, storage);
+    auto fill_both = [&] {
+        for (uint8_t bank = 0; bank < 2; ++bank) {
+            flash_bank(save, bank);
+            flash_program(save, 0x0000, static_cast<uint8_t>(0x10 + bank));
+            flash_program(save, 0x1000, static_cast<uint8_t>(0x20 + bank));
+            flash_program(save, 0x1FFF, static_cast<uint8_t>(0x30 + bank));
+        }
+    };
+    auto at = [&](uint8_t bank, uint32_t off) { return save.bytes()[bank * 0x10000u + off]; };
+
+    // Sector erase clears 4KB of the selected bank only
+    fill_both();
+    flash_bank(save, 1);
+    flash_command(save, 0x80);
+    flash_command(save, 0x30, 0x1000);
+    check(at(1, 0x1000) == 0xFF && at(1, 0x1FFF) == 0xFF, "sector erase in bank 1");
+    check(at(1, 0x0000) == 0x11, "sector erase keeps bank 1 sector 0");
+    check(at(0, 0x1000) == 0x20 && at(0, 0x1FFF) == 0x30, "bank 1 sector erase keeps bank 0");
+    flash_bank(save, 0);
+    flash_command(save, 0x80);
+    flash_command(save, 0x30, 0x1000);
+    check(at(0, 0x1000) == 0xFF && at(0, 0x1FFF) == 0xFF, "sector erase in bank 0");
+    check(at(0, 0x0000) == 0x10 && at(1, 0x0000) == 0x11, "bank 0 sector erase keeps other sectors");
+
+    // Chip erase clears both banks whichever is selected
+    fill_both();
+    flash_bank(save, 1);
+    flash_command(save, 0x80);
+    flash_command(save, 0x10);
+    bool erased = true;
+    for (uint8_t b : save.bytes()) erased = erased && b == 0xFF;
+    check(erased, "chip erase clears both banks");
+}
+
+}
+
+int main(int argc, char** argv) {
+    if (argc != 2) {
+        std::fprintf(stderr, "Usage: gba_save_test <scratch dir>\n");
+        return 2;
+    }
+    eeprom_8k();
+    eeprom_512();
+    eeprom_512_from_file(argv[1]);
+    flash_id();
+    flash_erase();
+    if (failures) return 1;
+    std::printf("save tests passed\n");
+    return 0;
+}
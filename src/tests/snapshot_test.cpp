@@ -0,0 +1,134 @@
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <vector>
+#include "../gba.hpp"
+
+// Checks for GBA::snapshot()/Snapshot::spawn()/clone() and the MemoryArena
+// remapping behind them. Run by ctest; exits non-zero on the first failure.
+
+namespace {
+
+int failures = 0;
+
+void check(bool ok, const char* what, bool huge) {
+    if (!ok) {
+        std::fprintf(stderr, "FAIL%s: %s\n", huge ? " (huge pages)" : "", what);
+        ++failures;
+    }
+}
+
+constexpr uint32_t WRAM = gba::Bus::WRAM_BASE;
+constexpr uint32_t VRAM = gba::Bus::VRAM_BASE;
+constexpr uint32_t ROM = gba::Bus::ROM_BASE;
+constexpr uint32_t SAVE = gba::Bus::SAVE_BASE;
+
+std::unique_ptr<gba::GBA> make_parent(bool huge, uint8_t rom_byte) {
+    gba::MemoryArena::Options opts;
+    opts.huge_pages = huge;
+    auto system = std::make_unique<gba::GBA>(opts);
+    system->reset();
+    system->load(std::vector<uint8_t>(4096, rom_byte));
+    return system;
+}
+
+void parent_child_isolated(bool huge) {
+    auto parent = make_parent(huge, 0x11);
+    parent->bus.write32(WRAM, 0xAAAA5555);
+    parent->bus.write16(VRAM, 0x1234);
+    auto child = parent->clone();
+    check(child->bus.read32(WRAM) == 0xAAAA5555, "child sees parent WRAM", huge);
+    check(child->bus.read16(VRAM) == 0x1234, "child sees parent VRAM", huge);
+
+    child->bus.write32(WRAM, 0x01020304);
+    parent->bus.write16(VRAM, 0x4321);
+    check(parent->bus.read32(WRAM) == 0xAAAA5555, "child write leaks into parent", huge);
+    check(child->bus.read16(VRAM) == 0x1234, "parent write leaks into child", huge);
+    check(child->bus.read32(WRAM) == 0x01020304, "child keeps its own write", huge);
+}
+
+void clone_of_clone(bool huge) {
+    auto parent = make_parent(huge, 0x22);
+    parent->bus.write8(WRAM, 1);
+    auto child = parent->clone();
+    child->bus.write8(WRAM + 1, 2);
+    auto grandchild = child->clone();
+    grandchild->bus.write8(WRAM + 2, 3);
+    check(grandchild->bus.read8(WRAM) == 1 && grandchild->bus.read8(WRAM + 1) == 2,
+          "grandchild sees parent and child writes", huge);
+    check(child->bus.read8(WRAM + 2) == 0, "grandchild write leaks into child", huge);
+    check(parent->bus.read8(WRAM + 1) == 0, "child write leaks into parent", huge);
+    check(grandchild->bus.read8(ROM) == 0x22, "grandchild ROM", huge);
+}
+
+void parent_reload_keeps_child_rom(bool huge) {
+    auto parent = make_parent(huge, 0x33);
+    auto child = parent->clone();
+    parent->load(std::vector<uint8_t>(8192, 0x44));
+    check(parent->bus.read8(ROM) == 0x44, "parent sees its new ROM", huge);
+    check(child->bus.read8(ROM) == 0x33 && child->cart.rom.size() == 4096, "child ROM survives parent reload", huge);
+}
+
+void many_spawns(bool huge) {
+    auto parent = make_parent(huge, 0x55);
+    parent->bus.write32(WRAM, 0xC0FFEE);
+    auto snap = parent->snapshot();
+    std::vector<std::unique_ptr<gba::GBA>> children;
+    for (uint32_t i = 0; i < 64; ++i) {
+        children.push_back(snap.spawn());
+        children.back()->bus.write32(WRAM + 4, i);
+    }
+    for (uint32_t i = 0; i < children.size(); ++i) {
+        check(children[i]->bus.read32(WRAM) == 0xC0FFEE, "spawn sees snapshot WRAM", huge);
+        check(children[i]->bus.read32(WRAM + 4) == i, "spawns are isolated", huge);
+    }
+    check(parent->bus.read32(WRAM + 4) == 0, "spawn write leaks into parent", huge);
+}
+
+void save_shared_copy_on_write(bool huge) {
+    auto parent = make_parent(huge, 0x77);
+    parent->open_anonymous_save(gba::SaveType::Sram);
+    parent->bus.write8(SAVE + 5, 0x77);
+    auto child = parent->clone();
+    check(child->cart.save.bytes().data() == child->arena.save().data(), "clone save lives in its arena", huge);
+    check(child->bus.read8(SAVE + 5) == 0x77, "clone sees parent save", huge);
+    child->bus.write8(SAVE + 5, 0x11);
+    parent->bus.write8(SAVE + 6, 0x22);
+    check(parent->bus.read8(SAVE + 5) == 0x77, "clone save write leaks into parent", huge);
+    check(child->bus.read8(SAVE + 6) == 0xFF, "parent save write leaks into clone", huge);
+}
+
+void flash_command_survives_clone(bool huge) {
+    auto parent = make_parent(huge, 0x66);
+    parent->open_anonymous_save(gba::SaveType::Flash128K);
+    // Select bank 1, then start a byte program and clone before the data byte
+    parent->bus.write8(SAVE + 0x5555, 0xAA);
+    parent->bus.write8(SAVE + 0x2AAA, 0x55);
+    parent->bus.write8(SAVE + 0x5555, 0xB0);
+    parent->bus.write8(SAVE, 1);
+    parent->bus.write8(SAVE + 0x5555, 0xAA);
+    parent->bus.write8(SAVE + 0x2AAA, 0x55);
+    parent->bus.write8(SAVE + 0x5555, 0xA0);
+    auto child = parent->clone();
+    child->bus.write8(SAVE + 0x10, 0x42);
+    check(child->bus.read8(SAVE + 0x10) == 0x42, "clone continues a pending Flash program", huge);
+    check(child->cart.save.bytes()[0x10010] == 0x42, "clone keeps the selected Flash bank", huge);
+    check(parent->cart.save.bytes()[0x10010] == 0xFF, "clone Flash write leaks into parent", huge);
+}
+
+}
+
+int main() {
+    // Huge pages fall back to ordinary ones when the pool is empty; run both
+    for (bool huge : {false, true}) {
+        parent_child_isolated(huge);
+        clone_of_clone(huge);
+        parent_reload_keeps_child_rom(huge);
+        many_spawns(huge);
+        save_shared_copy_on_write(huge);
+        flash_command_survives_clone(huge);
+    }
+    if (failures) return 1;
+    std::printf("snapshot tests passed (copy-on-write: %s)\n", gba::MemoryArena::supports_cow() ? "yes" : "no");
+    return 0;
+}
@@ -0,0 +1,113 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+namespace gba {
+
+// Tiny Thumb assembler covering the subset the CPU executes today. Used by
+// romgen, the workload generators and the benchmarks to build ROMs without an
+// Arm toolchain. Code is assembled for execution from 0x08000000.
+//
+// PC-relative branches follow the emulator's current convention (offset taken
+// from the address of the branch + 2), the same as the original romgen.
+struct ThumbAsm {
+    using Label = size_t;
+
+    enum class Cond : uint16_t {
+        EQ = 0x0, NE = 0x1, CS = 0x2, CC = 0x3, MI = 0x4, PL = 0x5, VS = 0x6, VC = 0x7,
+        HI = 0x8, LS = 0x9, GE = 0xA, LT = 0xB, GT = 0xC, LE = 0xD,
+    };
+
+    enum class Alu : uint16_t {
+        AND = 0x0, EOR, LSL, LSR, ASR, ADC, SBC, ROR, TST, NEG, CMP, CMN, ORR, MUL, BIC, MVN,
+    };
+
+    std::vector<uint16_t> code;
+
+    // Labels
+    Label new_label() { labels.push_back(UNBOUND); return labels.size() - 1; }
+    void bind(Label l) { labels[l] = code.size(); }
+    Label here() { Label l = new_label(); bind(l); return l; }
+
+    // Raw halfword
+    void emit(uint16_t hw) { code.push_back(hw); }
+
+    // Shifts by immediate
+    void lsl(uint32_t rd, uint32_t rs, uint32_t imm5) { emit(static_cast<uint16_t>(0x0000 | ((imm5 & 0x1F) << 6) | (rs << 3) | rd)); }
+    void lsr(uint32_t rd, uint32_t rs, uint32_t imm5) { emit(static_cast<uint16_t>(0x0800 | ((imm5 & 0x1F) << 6) | (rs << 3) | rd)); }
+    void asr(uint32_t rd, uint32_t rs, uint32_t imm5) { emit(static_cast<uint16_t>(0x1000 | ((imm5 & 0x1F) << 6) | (rs << 3) | rd)); }
+
+    // MOV/CMP/ADD/SUB immediate
+    void mov(uint32_t rd, uint32_t imm8) { emit(static_cast<uint16_t>(0x2000 | (rd << 8) | (imm8 & 0xFF))); }
+    void cmp(uint32_t rd, uint32_t imm8) { emit(static_cast<uint16_t>(0x2800 | (rd << 8) | (imm8 & 0xFF))); }
+    void add(uint32_t rd, uint32_t imm8) { emit(static_cast<uint16_t>(0x3000 | (rd << 8) | (imm8 & 0xFF))); }
+    void sub(uint32_t rd, uint32_t imm8) { emit(static_cast<uint16_t>(0x3800 | (rd << 8) | (imm8 & 0xFF))); }
+
+    // ALU register operations: op Rd, Rs
+    void alu(Alu op, uint32_t rd, uint32_t rs) { emit(static_cast<uint16_t>(0x4000 | (static_cast<uint16_t>(op) << 6) | (rs << 3) | rd)); }
+
+    // Loads/stores with immediate byte offset (must be aligned and in range)
+    void str(uint32_t rd, uint32_t rb, uint32_t off = 0)  { emit(static_cast<uint16_t>(0x6000 | (((off >> 2) & 0x1F) << 6) | (rb << 3) | rd)); }
+    void ldr(uint32_t rd, uint32_t rb, uint32_t off = 0)  { emit(static_cast<uint16_t>(0x6800 | (((off >> 2) & 0x1F) << 6) | (rb << 3) | rd)); }
+    void strb(uint32_t rd, uint32_t rb, uint32_t off = 0) { emit(static_cast<uint16_t>(0x7000 | ((off & 0x1F) << 6) | (rb << 3) | rd)); }
+    void ldrb(uint32_t rd, uint32_t rb, uint32_t off = 0) { emit(static_cast<uint16_t>(0x7800 | ((off & 0x1F) << 6) | (rb << 3) | rd)); }
+    void strh(uint32_t rd, uint32_t rb, uint32_t off = 0) { emit(static_cast<uint16_t>(0x8000 | (((off >> 1) & 0x1F) << 6) | (rb << 3) | rd)); }
+    void ldrh(uint32_t rd, uint32_t rb, uint32_t off = 0) { emit(static_cast<uint16_t>(0x8800 | (((off >> 1) & 0x1F) << 6) | (rb << 3) | rd)); }
+
+    // Branches (resolved in assemble())
+    void b(Label target) { fixups.push_back({code.size(), target, false}); emit(0xE000); }
+    void b(Cond c, Label target) { fixups.push_back({code.size(), target, true}); emit(static_cast<uint16_t>(0xD000 | (static_cast<uint16_t>(c) << 8))); }
+    void halt() { emit(0xE7FF); } // B .
+
+    // Rd = value using MOV/LSL/ADD (flags clobbered)
+    void load_imm32(uint32_t rd, uint32_t value) {
+        int top = 3;
+        while (top > 0 && ((value >> (top * 8)) & 0xFF) == 0) --top;
+        mov(rd, (value >> (top * 8)) & 0xFF);
+        uint32_t pending = 0;
+        for (int i = top - 1; i >= 0; --i) {
+            pending += 8;
+            uint32_t byte = (value >> (i * 8)) & 0xFF;
+            if (byte) {
+                lsl(rd, rd, pending);
+                add(rd, byte);
+                pending = 0;
+            }
+        }
+        if (pending) lsl(rd, rd, pending);
+    }
+
+    // Resolve branches and produce little-endian ROM bytes. Returns false if a
+    // label is unbound or a branch is out of range.
+    bool assemble(std::vector<uint8_t>& out) {
+        for (const auto& f : fixups) {
+            if (labels[f.target] == UNBOUND) return false;
+            int64_t rel = static_cast<int64_t>(labels[f.target]) - static_cast<int64_t>(f.at + 1);
+            if (f.conditional) {
+                if (rel < -128 || rel > 127) return false;
+                code[f.at] = static_cast<uint16_t>(code[f.at] | (rel & 0xFF));
+            } else {
+                if (rel < -1024 || rel > 1023) return false;
+                code[f.at] = static_cast<uint16_t>(code[f.at] | (rel & 0x7FF));
+            }
+        }
+        fixups.clear();
+        out.clear();
+        out.reserve(code.size() * 2);
+        for (uint16_t hw : code) {
+            out.push_back(static_cast<uint8_t>(hw & 0xFF));
+            out.push_back(static_cast<uint8_t>(hw >> 8));
+        }
+        return true;
+    }
+
+private:
+    static constexpr size_t UNBOUND = static_cast<size_t>(-1);
+
+    struct Fixup { size_t at; Label target; bool conditional; };
+    std::vector<size_t> labels;
+    std::vector<Fixup> fixups;
+};
+
+}
@@ -0,0 +1,88 @@
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include "../debug/trace.hpp"
+
+// Compare two execution traces written by `gba_headless --trace` and report
+// the first instruction where PC, opcode, r0-r14 or CPSR diverge.
+//
+//   tracediff <a.trace> <b.trace>
+// Exit code: 0 identical, 1 divergence, 2 usage or I/O error.
+
+// `indexed` is false for the header state, which precedes instruction #0
+static void print_record(const char* label, const gba::TraceRecord& rec, bool indexed = true) {
+    if (indexed) {
+        std::printf("  %s: #%llu pc=0x%08x op=0x%04x cpsr=0x%08x\n", label,
+            static_cast<unsigned long long>(rec.index), rec.pc, rec.opcode, rec.cpsr);
+    } else {
+        std::printf("  %s: pc=0x%08x cpsr=0x%08x\n", label, rec.pc, rec.cpsr);
+    }
+    std::printf("     ");
+    for (int i = 0; i < 15; ++i) {
+        std::printf(" r%d=%08x", i, rec.r[i]);
+        if (i == 7) std::printf("\n     ");
+    }
+    std::printf("\n");
+}
+
+static bool same_state(const gba::TraceRecord& a, const gba::TraceRecord& b) {
+    if (a.pc != b.pc || a.opcode != b.opcode || a.cpsr != b.cpsr) return false;
+    for (int i = 0; i < 15; ++i) {
+        if (a.r[i] != b.r[i]) return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    if (argc != 3) {
+        std::fprintf(stderr, "Usage: tracediff <a.trace> <b.trace>\n");
+        return 2;
+    }
+    gba::TraceReader ta, tb;
+    if (!ta.open(argv[1])) { std::fprintf(stderr, "Cannot read trace: %s\n", argv[1]); return 2; }
+    if (!tb.open(argv[2])) { std::fprintf(stderr, "Cannot read trace: %s\n", argv[2]); return 2; }
+
+    if (!same_state(ta.initial(), tb.initial())) {
+        std::printf("Initial states differ\n");
+        print_record("a", ta.initial(), false);
+        print_record("b", tb.initial(), false);
+        return 1;
+    }
+
+    gba::TraceRecord a, b, prev = ta.initial();
+    uint64_t compared = 0;
+    for (;;) {
+        bool hasA = ta.next(a);
+        bool hasB = tb.next(b);
+        if (ta.error() || tb.error()) {
+            std::fprintf(stderr, "Truncated or corrupt trace: %s\n", ta.error() ? argv[1] : argv[2]);
+            return 2;
+        }
+        if (!hasA && !hasB) break;
+        if (hasA != hasB) {
+            std::printf("Traces diverge in length after %llu instructions: %s ends first\n",
+                static_cast<unsigned long long>(compared), hasA ? argv[2] : argv[1]);
+            if (compared) print_record("last common", prev);
+            else print_record("initial", prev, false);
+            return 1;
+        }
+        if (!same_state(a, b)) {
+            std::printf("First divergence at instruction #%llu\n", static_cast<unsigned long long>(a.index));
+            if (a.pc != b.pc) std::printf("  pc differs\n");
+            if (a.opcode != b.opcode) std::printf("  opcode differs\n");
+            for (int i = 0; i < 15; ++i) {
+                if (a.r[i] != b.r[i]) std::printf("  r%d: %08x vs %08x\n", i, a.r[i], b.r[i]);
+            }
+            if (a.cpsr != b.cpsr) std::printf("  cpsr: %08x vs %08x\n", a.cpsr, b.cpsr);
+            if (compared) print_record("previous", prev);
+            else print_record("initial", prev, false);
+            print_record("a", a);
+            print_record("b", b);
+            return 1;
+        }
+        prev = a;
+        ++compared;
+    }
+    std::printf("Traces identical (%llu instructions)\n", static_cast<unsigned long long>(compared));
+    return 0;
+}
@@ -0,0 +1,240 @@
+#include "workloads.hpp"
+#include "thumb_asm.hpp"
+#include <algorithm>
+#include <cstdio>
+
+namespace gba {
+
+using Alu = ThumbAsm::Alu;
+using Cond = ThumbAsm::Cond;
+
+namespace {
+
+constexpr uint32_t WRAM_BASE = 0x02000000;
+constexpr uint32_t VRAM_BASE = 0x06000000;
+constexpr uint32_t SRAM_BASE = 0x0E000000;
+constexpr uint32_t PIXELS = 240 * 160;
+
+// r7 is the outer iteration counter in every workload
+constexpr uint32_t COUNTER = 7;
+
+const WorkloadInfo WORKLOADS[] = {
+    {"fill",      "original romgen program: fill pixels with one color, then spin",
+                  "pixels", 200, PIXELS, 1},
+    {"alu",       "unrolled register ALU/shift/multiply mix in r0-r5",
+                  "instructions per iteration", 256, 900, 2000},
+    {"loadstore", "word/half/byte copies between WRAM and VRAM in both directions",
+                  "bytes per iteration", 16384, PIXELS * 2, 32},
+    {"branchy",   "xorshift PRNG driving data-dependent conditional branches",
+                  "branches per iteration", 64, 192, 2000},
+    {"mode3",     "full Mode 3 redraw with a per-pixel color gradient",
+                  "pixels per frame", PIXELS, PIXELS, 8},
+    {"sram",      "read-modify-write of battery-backed SRAM bytes (persists across runs)",
+                  "bytes per iteration", 1024, 32 * 1024, 16},
+};
+
+uint32_t xorshift(uint32_t& s) {
+    s ^= s << 13; s ^= s >> 17; s ^= s << 5;
+    return s;
+}
+
+// Outer loop helpers: r7 counts down; 0 iterations loops forever
+void begin_outer(ThumbAsm& a, const WorkloadParams& p) {
+    if (p.iterations) a.load_imm32(COUNTER, p.iterations);
+}
+
+void end_outer(ThumbAsm& a, const WorkloadParams& p, ThumbAsm::Label top) {
+    if (!p.iterations) {
+        a.b(top);
+        return;
+    }
+    // BNE only reaches 128 halfwords back; bodies are larger, so hop over a B
+    ThumbAsm::Label done = a.new_label();
+    a.sub(COUNTER, 1);
+    a.b(Cond::EQ, done);
+    a.b(top);
+    a.bind(done);
+    // Result signature: r0-r5 to the first 24 bytes of VRAM
+    a.load_imm32(6, VRAM_BASE);
+    for (uint32_t r = 0; r < 6; ++r) a.str(r, 6, r * 4);
+    a.halt();
+}
+
+void gen_fill(ThumbAsm& a, const WorkloadParams& p, uint32_t size) {
+    // Identical to the original hand-encoded program for counts up to 255
+    a.mov(2, 6);
+    a.lsl(2, 2, 24);
+    a.mov(3, p.color & 0xFF);
+    a.mov(4, (p.color >> 8) & 0xFF);
+    a.lsl(4, 4, 8);
+    a.alu(Alu::ORR, 3, 4);
+    a.load_imm32(5, size);
+    ThumbAsm::Label loop = a.here();
+    a.strh(3, 2);
+    a.add(2, 2);
+    a.sub(5, 1);
+    a.cmp(5, 0);
+    a.b(Cond::NE, loop);
+    a.halt();
+}
+
+void gen_alu(ThumbAsm& a, const WorkloadParams& p, uint32_t size) {
+    uint32_t s = p.seed ? p.seed : 1;
+    for (uint32_t r = 0; r < 6; ++r) a.load_imm32(r, xorshift(s));
+    begin_outer(a, p);
+    ThumbAsm::Label top = a.here();
+    static constexpr Alu REG_OPS[] = {
+        Alu::AND, Alu::EOR, Alu::ADC, Alu::SBC, Alu::ROR, Alu::ORR, Alu::MUL, Alu::BIC, Alu::MVN, Alu::NEG, Alu::CMN,
+    };
+    for (uint32_t i = 0; i < size; ++i) {
+        uint32_t v = xorshift(s);
+        uint32_t rd = v % 6, rs = (v >> 8) % 6;
+        switch ((v >> 16) % 6) {
+            case 0: a.add(rd, (v >> 20) & 0xFF); break;
+            case 1: a.sub(rd, (v >> 20) & 0xFF); break;
+            case 2: a.lsl(rd, rs, (v >> 20) & 0x1F); break;
+            case 3: a.lsr(rd, rs, (v >> 20) & 0x1F); break;
+            default: a.alu(REG_OPS[(v >> 20) % std::size(REG_OPS)], rd, rs); break;
+        }
+    }
+    end_outer(a, p, top);
+}
+
+void gen_loadstore(ThumbAsm& a, const WorkloadParams& p, uint32_t size) {
+    constexpr uint32_t CHUNK = 32;
+    uint32_t chunks = std::max<uint32_t>(1, size / CHUNK);
+    begin_outer(a, p);
+    ThumbAsm::Label top = a.here();
+    a.load_imm32(5, WRAM_BASE);
+    a.load_imm32(6, VRAM_BASE);
+    a.load_imm32(4, chunks);
+    ThumbAsm::Label chunk = a.here();
+    // WRAM -> VRAM, mixing in the iteration counter so every pass differs
+    a.ldr(0, 5, 0);   a.alu(Alu::EOR, 0, COUNTER); a.str(0, 6, 0);
+    a.ldr(1, 5, 4);   a.str(1, 6, 4);
+    a.ldrh(2, 5, 8);  a.alu(Alu::EOR, 2, COUNTER); a.strh(2, 6, 8);
+    a.ldrh(3, 5, 10); a.strh(3, 6, 10);
+    a.ldrb(0, 5, 12); a.strb(0, 6, 12);
+    a.ldrb(1, 5, 13); a.strb(1, 6, 13);
+    // VRAM -> WRAM
+    a.ldr(0, 6, 16);  a.alu(Alu::ADC, 0, 1); a.str(0, 5, 16);
+    a.ldr(1, 6, 20);  a.str(1, 5, 20);
+    a.ldrh(2, 6, 24); a.strh(2, 5, 24);
+    a.ldrh(3, 6, 26); a.alu(Alu::ORR, 3, COUNTER); a.strh(3, 5, 26);
+    a.ldrb(0, 6, 28); a.strb(0, 5, 28);
+    a.ldrb(1, 6, 30); a.strb(1, 5, 30);
+    a.add(5, CHUNK);
+    a.add(6, CHUNK);
+    a.sub(4, 1);
+    a.b(Cond::NE, chunk);
+    end_outer(a, p, top);
+}
+
+void gen_branchy(ThumbAsm& a, const WorkloadParams& p, uint32_t size) {
+    uint32_t s = p.seed ? p.seed : 1;
+    a.load_imm32(0, xorshift(s) | 1); // PRNG state must be non-zero
+    for (uint32_t r = 2; r < 6; ++r) a.mov(r, 0);
+    begin_outer(a, p);
+    ThumbAsm::Label top = a.here();
+    for (uint32_t i = 0; i < size; ++i) {
+        if (i % 4 == 0) {
+            // r0 = xorshift32(r0)
+            a.lsl(1, 0, 13); a.alu(Alu::EOR, 0, 1);
+            a.lsr(1, 0, 17); a.alu(Alu::EOR, 0, 1);
+            a.lsl(1, 0, 5);  a.alu(Alu::EOR, 0, 1);
+        }
+        uint32_t v = xorshift(s);
+        uint32_t bit = 1 + (v % 30);
+        ThumbAsm::Label skip = a.new_label();
+        // Test one PRNG bit via N (LSL) or C (LSR); ~50% taken, unpredictable
+        if (v & 0x100) {
+            a.lsl(1, 0, bit);
+            a.b((v & 0x200) ? Cond::MI : Cond::PL, skip);
+        } else {
+            a.lsr(1, 0, bit);
+            a.b((v & 0x200) ? Cond::CS : Cond::CC, skip);
+        }
+        a.add(2 + (i % 4), 1);
+        a.bind(skip);
+    }
+    end_outer(a, p, top);
+}
+
+void gen_mode3(ThumbAsm& a, const WorkloadParams& p, uint32_t size) {
+    a.load_imm32(3, p.seed & 0x7FFF);
+    begin_outer(a, p);
+    ThumbAsm::Label top = a.here();
+    a.load_imm32(2, VRAM_BASE);
+    a.load_imm32(5, size);
+    ThumbAsm::Label pixel = a.here();
+    a.strh(3, 2);
+    a.add(2, 2);
+    a.add(3, 1);
+    a.sub(5, 1);
+    a.b(Cond::NE, pixel);
+    end_outer(a, p, top);
+}
+
+void gen_sram(ThumbAsm& a, const WorkloadParams& p, uint32_t size) {
+    // Every byte gains `iterations` per run; r1 folds in everything written,
+    // so the signature depends on what earlier runs left in the save
+    a.mov(1, 0);
+    begin_outer(a, p);
+    ThumbAsm::Label top = a.here();
+    a.load_imm32(5, SRAM_BASE);
+    a.load_imm32(4, size);
+    ThumbAsm::Label byte = a.here();
+    a.ldrb(0, 5);
+    a.add(0, 1);
+    a.strb(0, 5);
+    a.alu(Alu::EOR, 1, 0);
+    a.add(5, 1);
+    a.sub(4, 1);
+    a.b(Cond::NE, byte);
+    end_outer(a, p, top);
+}
+
+}
+
+std::span<const WorkloadInfo> workloads() { return WORKLOADS; }
+
+const WorkloadInfo* find_workload(const std::string& name) {
+    for (const auto& w : WORKLOADS) {
+        if (name == w.name) return &w;
+    }
+    return nullptr;
+}
+
+bool build_workload(const std::string& name, const WorkloadParams& params, std::vector<uint8_t>& out) {
+    const WorkloadInfo* info = find_workload(name);
+    if (!info) return false;
+    uint32_t size = params.size ? params.size : info->default_size;
+    if (size > info->max_size) return false; // never build something other than asked
+
+    ThumbAsm a;
+    if (name == "fill") gen_fill(a, params, size);
+    else if (name == "alu") gen_alu(a, params, size);
+    else if (name == "loadstore") gen_loadstore(a, params, size);
+    else if (name == "branchy") gen_branchy(a, params, size);
+    else if (name == "mode3") gen_mode3(a, params, size);
+    else if (name == "sram") gen_sram(a, params, size);
+    if (!a.assemble(out)) return false;
+
+    // Library ID string games use to declare their save memory type
+    if (name == "sram") {
+        static constexpr char SAVE_ID[] = "SRAM_V113";
+        while (out.size() % 4) out.push_back(0);
+        out.insert(out.end(), SAVE_ID, SAVE_ID + sizeof(SAVE_ID));
+    }
+
+    // Never executed: describes how the ROM was generated
+    char tag[160];
+    int n = std::snprintf(tag, sizeof(tag), "GBAEMU-WORKLOAD v%u %s size=%u iterations=%u seed=%u color=0x%04X",
+        WORKLOAD_VERSION, info->name, size, params.iterations, params.seed, params.color);
+    while (out.size() % 4) out.push_back(0);
+    out.insert(out.end(), tag, tag + n);
+    out.push_back(0);
+    return true;
+}
+
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace gba {
+
+// Named, reproducible performance-workload ROMs shared by romgen, gba_bench
+// and the headless regression tests.
+//
+// Every workload runs an outer loop `iterations` times (0 = forever). Finite
+// runs then store r0-r5 to the start of VRAM as a result signature and halt,
+// so a VRAM hash also checks CPU results. Same name + params + version always
+// yields the same bytes; an ASCII tag describing them follows the code.
+
+// Bump when any generator changes its output for the same parameters
+inline constexpr uint32_t WORKLOAD_VERSION = 1;
+
+struct WorkloadParams {
+    uint32_t size = 0;         // workload-specific unit (see WorkloadInfo), 0 = default
+    uint32_t iterations = 0;   // outer loop count, 0 = run forever
+    uint32_t seed = 1;         // drives instruction/data choices
+    uint16_t color = 0x001F;   // BGR555, used by "fill"
+};
+
+struct WorkloadInfo {
+    const char* name;
+    const char* description;
+    const char* size_unit;
+    uint32_t default_size;
+    uint32_t max_size;
+    uint32_t default_iterations; // finite default used by romgen/tests
+};
+
+std::span<const WorkloadInfo> workloads();
+const WorkloadInfo* find_workload(const std::string& name);
+
+// Generate ROM bytes; returns false for an unknown name or a size over max_size
+bool build_workload(const std::string& name, const WorkloadParams& params, std::vector<uint8_t>& out);
+
+}
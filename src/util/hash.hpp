@@ -0,0 +1,35 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+namespace gba {
+
+// Fast non-cryptographic 64-bit hash for frame buffers and other bulk memory.
+// Consumes 8 bytes per round (multiply-rotate, in the spirit of xxHash/wyhash);
+// good enough to tell frames apart, not for anything adversarial.
+inline uint64_t hash64(const void* data, size_t len, uint64_t seed = 0) {
+    constexpr uint64_t P1 = 0x9E3779B185EBCA87ull;
+    constexpr uint64_t P2 = 0xC2B2AE3D27D4EB4Full;
+    auto rotl = [](uint64_t v, int s) { return (v << s) | (v >> (64 - s)); };
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    uint64_t h = seed ^ (len * P1);
+    while (len >= 8) {
+        uint64_t w;
+        std::memcpy(&w, p, 8);
+        h = rotl(h ^ (w * P2), 31) * P1;
+        p += 8; len -= 8;
+    }
+    if (len) {
+        uint64_t w = 0;
+        std::memcpy(&w, p, len);
+        h = rotl(h ^ (w * P2), 31) * P1;
+    }
+    // Final avalanche
+    h ^= h >> 33; h *= P2;
+    h ^= h >> 29; h *= P1;
+    h ^= h >> 32;
+    return h;
+}
+
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include <charconv>
+#include <cstdint>
+#include <limits>
+#include <string_view>
+#include <system_error>
+
+namespace gba {
+
+// Command-line number parsing that reports bad input instead of throwing.
+// The whole string must be consumed and the value must fit in T.
+
+// Decimal, or hex with a 0x prefix; base 16 takes the prefix as optional
+template <typename T>
+bool parse_uint(std::string_view s, T& out, int base = 0) {
+    if (s.size() > 2 && s[0] == '0' && (s[1] == 'x' || s[1] == 'X') && (base == 0 || base == 16)) {
+        s.remove_prefix(2);
+        base = 16;
+    } else if (base == 0) {
+        base = 10;
+    }
+    uint64_t v = 0;
+    auto [end, ec] = std::from_chars(s.data(), s.data() + s.size(), v, base);
+    if (ec != std::errc{} || end != s.data() + s.size() || s.empty()) return false;
+    if (v > std::numeric_limits<T>::max()) return false;
+    out = static_cast<T>(v);
+    return true;
+}
+
+inline bool parse_double(std::string_view s, double& out) {
+    auto [end, ec] = std::from_chars(s.data(), s.data() + s.size(), out);
+    return ec == std::errc{} && end == s.data() + s.size() && !s.empty();
+}
+
+}